@@ -1,15 +1,180 @@
 #pragma once
+#include <compare>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <ranges>
 
 namespace std::ranges::__detail {
 
-template<class Comp, class... Views>
-constexpr bool __pairwise_indirect_strict_weak_order =
-  (indirect_strict_weak_order<Comp, iterator_t<Views>> && ...);
-template<class Comp, class First, class... Views>
+// A comparator that returns the ordering of its arguments, such as compare_three_way, rather than
+// whether the first is less. One call then tells the merges all they need.
+template<class Comp, class T, class U>
+concept __three_way_order_with =
+  invocable<Comp, T, U> && invocable<Comp, U, T> &&
+  convertible_to<invoke_result_t<Comp, T, U>, weak_ordering> &&
+  convertible_to<invoke_result_t<Comp, U, T>, weak_ordering>;
+
+// Comparators the set views and algorithms accept: a strict weak order, or a three-way
+// comparator yielding at least a weak_ordering.
+template<class Comp, class T, class U = T>
+concept __set_order = strict_weak_order<Comp, T, U> || __three_way_order_with<Comp, T, U>;
+
+template<class Comp, class I1, class I2>
+concept __indirect_three_way_order =
+  indirectly_readable<I1> && indirectly_readable<I2> && copy_constructible<Comp> &&
+  __three_way_order_with<Comp&, iter_value_t<I1>&, iter_value_t<I2>&> &&
+  __three_way_order_with<Comp&, iter_reference_t<I1>, iter_reference_t<I2>> &&
+  __three_way_order_with<Comp&, iter_common_reference_t<I1>, iter_common_reference_t<I2>>;
+
+template<class Comp, class I1, class I2 = I1>
+concept __indirect_set_order =
+  indirect_strict_weak_order<Comp, I1, I2> || __indirect_three_way_order<Comp, I1, I2>;
+
+template<class Comp, class Proj, class... Views>
+constexpr bool __pairwise_projected_set_order =
+  (__indirect_set_order<Comp, projected<iterator_t<Views>, Proj>> && ...);
+template<class Comp, class Proj, class First, class... Views>
   requires(sizeof...(Views) > 0)
-constexpr bool __pairwise_indirect_strict_weak_order<Comp, First, Views...> =
-  (indirect_strict_weak_order<Comp, iterator_t<First>, iterator_t<Views>> && ...) &&
-  __pairwise_indirect_strict_weak_order<Comp, Views...>;
+constexpr bool __pairwise_projected_set_order<Comp, Proj, First, Views...> =
+  (__indirect_set_order<Comp, projected<iterator_t<First>, Proj>,
+                        projected<iterator_t<Views>, Proj>> &&
+   ...) &&
+  __pairwise_projected_set_order<Comp, Proj, Views...>;
+
+template<class Comp, class... Views>
+constexpr bool __pairwise_indirect_set_order =
+  __pairwise_projected_set_order<Comp, identity, Views...>;
+
+// The projected key of the element under a cursor, computed once each time the cursor moves so
+// that comparisons never project. A key that is an lvalue into an lvalue element is kept by
+// address, any other key by value; identity projections store nothing and read through the
+// cursor.
+template<class Proj, class I>
+class __key_cache {
+  using key_type = indirect_result_t<Proj&, I>;
+  static constexpr bool by_address =
+    is_lvalue_reference_v<key_type> && is_lvalue_reference_v<iter_reference_t<I>>;
+
+  conditional_t<by_address, remove_reference_t<key_type>*, optional<remove_cvref_t<key_type>>>
+    key_{};
+
+ public:
+  template<class P, sentinel_for<I> S>
+  constexpr void
+  refresh(P& proj, const I& it, const S& end) {
+    if (it == end)
+      return;
+    if constexpr (by_address)
+      key_ = std::addressof(std::__invoke(proj, *it));
+    else
+      key_.emplace(std::__invoke(proj, *it));
+  }
+
+  constexpr decltype(auto)
+  get(const I&) const {
+    return *key_;
+  }
+};
+
+template<class I>
+class __key_cache<identity, I> {
+ public:
+  template<class P, sentinel_for<I> S>
+  constexpr void
+  refresh(P&, const I&, const S&) noexcept { }
+
+  constexpr decltype(auto)
+  get(const I& it) const {
+    return *it;
+  }
+};
+
+template<class Proj, class I>
+using __key_reference_t =
+  decltype(std::declval<const __key_cache<Proj, I>&>().get(std::declval<const I&>()));
+
+// How a view holds an element it may or may not have: an lvalue by reference, anything else by
+// value, since an optional cannot refer to an rvalue.
+template<class R>
+using __optional_element_t = conditional_t<is_lvalue_reference_v<R>, R, remove_cvref_t<R>>;
+
+// Whether a is ordered before b, in a single call to either kind of comparator.
+template<class Comp, class T, class U>
+constexpr bool
+__set_less(Comp& comp, T&& a, U&& b) {
+  if constexpr (__three_way_order_with<Comp&, T, U>)
+    return std::__invoke(comp, std::forward<T>(a), std::forward<U>(b)) < 0;
+  else
+    return std::__invoke(comp, std::forward<T>(a), std::forward<U>(b));
+}
+
+// The ordering of a relative to b: one call to a three-way comparator, or at most two to a
+// strict weak order.
+template<class Comp, class T, class U>
+constexpr weak_ordering
+__set_compare(Comp& comp, T&& a, U&& b) {
+  if constexpr (__three_way_order_with<Comp&, T, U>)
+    return std::__invoke(comp, std::forward<T>(a), std::forward<U>(b));
+  else if (std::__invoke(comp, a, b))
+    return weak_ordering::less;
+  else if (std::__invoke(comp, b, a))
+    return weak_ordering::greater;
+  else
+    return weak_ordering::equivalent;
+}
+
+// Ranges whose cursors can jump ahead in O(1) and measure the distance left to the end.
+template<class R>
+concept __gallopable = random_access_range<R> && sized_sentinel_for<sentinel_t<R>, iterator_t<R>>;
+
+// Returns the first iterator in [first, last) for which pred is false, assuming the range is
+// partitioned by pred. Probes at exponentially growing offsets before bisecting, so the cost is
+// logarithmic in the distance skipped rather than in the length of the range.
+template<random_access_iterator I, sized_sentinel_for<I> S, class Pred>
+constexpr I
+__gallop_partition_point(I first, S last, Pred pred) {
+  using D = iter_difference_t<I>;
+  const D n = last - first;
+  D lo = 0;
+  D hi = 1;
+  while (hi < n && pred(first[hi])) {
+    lo = hi;
+    hi *= 2;
+  }
+  if (hi > n)
+    hi = n;
+  first += lo;
+  D len = hi - lo;
+  while (len > 0) {
+    D half = len / 2;
+    I mid = first + half;
+    if (pred(*mid)) {
+      first = ++mid;
+      len -= half + 1;
+    } else
+      len = half;
+  }
+  return first;
+}
+
+// Moves it to the first element of [it, last) whose projected key is not less than key. A cursor
+// that is itself a set view iterator is asked to seek, so skips reach through nested views; this
+// assumes they order keys as comp does. Otherwise the cursor gallops when it can and steps when
+// it cannot.
+template<class Comp, class Proj, input_iterator I, sentinel_for<I> S, class Key>
+constexpr void
+__seek_to(Comp& comp, Proj& proj, I& it, const S& last, const Key& key) {
+  if constexpr (same_as<remove_cv_t<Proj>, identity> && requires { it.seek(key); }) {
+    if (it != last)
+      it.seek(key);
+  } else if constexpr (random_access_iterator<I> && sized_sentinel_for<S, I>)
+    it = __gallop_partition_point(std::move(it), last, [&](auto&& x) {
+      return __set_less(comp, std::__invoke(proj, std::forward<decltype(x)>(x)), key);
+    });
+  else
+    while (it != last && __set_less(comp, std::__invoke(proj, *it), key))
+      ++it;
+}
 
 }  // namespace std::ranges::__detail
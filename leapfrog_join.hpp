@@ -0,0 +1,483 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <ranges>
+#include <tuple>
+#include <utility>
+
+#include "concepts.h"
+#include "merge_tree.h"
+#include "set_intersection.h"
+
+namespace std::ranges {
+namespace __detail {
+// The element a row holds in column Col: a reference into the row when the row is an lvalue,
+// otherwise a copy, so that it never outlives a temporary row.
+template<class I, size_t Col>
+using __column_reference_t =
+  conditional_t<is_lvalue_reference_v<iter_reference_t<I>>,
+                decltype(std::get<Col>(std::declval<iter_reference_t<I>>())),
+                remove_cvref_t<tuple_element_t<Col, iter_value_t<I>>>>;
+
+// One level of a relation seen as a trie: the distinct values of column Col over rows
+// [first, last), which are sorted and agree on every column before Col. The cursor steps from one
+// value's run of rows to the next and seeks by galloping, so a set_intersection_view over levels
+// leapfrogs from one common value to the next.
+template<class Comp, random_access_iterator I, size_t Col>
+class __trie_level : public view_interface<__trie_level<Comp, I, Col>> {
+  I first_ = I();
+  I last_ = I();
+  Comp* comp_ = nullptr;
+
+  class iterator {
+    friend __trie_level;
+
+    I current_ = I();
+    I last_ = I();
+    Comp* comp_ = nullptr;
+
+    constexpr iterator(I current, I last, Comp* comp)
+      : current_(std::move(current)), last_(std::move(last)), comp_(comp) { }
+
+   public:
+    using iterator_concept = forward_iterator_tag;
+    using value_type = remove_cvref_t<tuple_element_t<Col, iter_value_t<I>>>;
+    using difference_type = iter_difference_t<I>;
+
+    iterator() = default;
+
+    constexpr __column_reference_t<I, Col>
+    operator*() const {
+      return std::get<Col>(*current_);
+    }
+
+    constexpr iterator&
+    operator++() {
+      auto&& value = **this;
+      current_ = __gallop_partition_point(std::move(current_), last_, [&](auto&& row) {
+        return !__set_less(*comp_, value, std::get<Col>(row));
+      });
+      return *this;
+    }
+
+    constexpr iterator
+    operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    // Moves to the first value not less than target.
+    template<class Key>
+      requires __set_order<Comp&, __column_reference_t<I, Col>, const Key&>
+    constexpr void
+    seek(const Key& target) {
+      current_ = __gallop_partition_point(std::move(current_), last_, [&](auto&& row) {
+        return __set_less(*comp_, std::get<Col>(row), target);
+      });
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y) {
+      return x.current_ == y.current_;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& it, default_sentinel_t) {
+      return it.current_ == it.last_;
+    }
+  };
+
+ public:
+  __trie_level() = default;
+
+  constexpr __trie_level(I first, I last, Comp* comp)
+    : first_(std::move(first)), last_(std::move(last)), comp_(comp) { }
+
+  constexpr iterator
+  begin() const {
+    return iterator(first_, last_, comp_);
+  }
+
+  constexpr default_sentinel_t
+  end() const noexcept {
+    return default_sentinel;
+  }
+};
+
+template<size_t... Vars>
+concept __ascending_variables = (sizeof...(Vars) > 0) && [] {
+  const size_t vars[]{Vars...};
+  return ranges::adjacent_find(vars, ranges::greater_equal{}) == ranges::end(vars);
+}();
+}  // namespace __detail
+
+// One atom of a join query: a relation whose rows are sorted lexicographically, and whose leading
+// columns bind the query variables Vars. Variables are numbered in the order the join binds them,
+// so Vars must ascend.
+template<view V, size_t... Vars>
+  requires __detail::__gallopable<V> && __detail::__ascending_variables<Vars...> &&
+  __detail::__has_tuple_element<range_value_t<V>, sizeof...(Vars) - 1> &&
+  __detail::__has_tuple_element<remove_reference_t<range_reference_t<V>>, sizeof...(Vars) - 1>
+class join_atom : public view_interface<join_atom<V, Vars...>> {
+  V base_ = V();  // exposition only
+
+ public:
+  static constexpr array<size_t, sizeof...(Vars)> variables{Vars...};
+
+  join_atom()
+    requires default_initializable<V>
+  = default;
+
+  constexpr explicit join_atom(V base) : base_(std::move(base)) { }
+
+  constexpr V
+  base() const&
+    requires copy_constructible<V>
+  {
+    return base_;
+  }
+
+  constexpr V
+  base() && {
+    return std::move(base_);
+  }
+
+  constexpr auto
+  begin() {
+    return ranges::begin(base_);
+  }
+
+  constexpr auto
+  begin() const
+    requires range<const V>
+  {
+    return ranges::begin(base_);
+  }
+
+  constexpr auto
+  end() {
+    return ranges::end(base_);
+  }
+
+  constexpr auto
+  end() const
+    requires range<const V>
+  {
+    return ranges::end(base_);
+  }
+
+  constexpr auto
+  size()
+    requires sized_range<V>
+  {
+    return ranges::size(base_);
+  }
+
+  constexpr auto
+  size() const
+    requires sized_range<const V>
+  {
+    return ranges::size(base_);
+  }
+};
+
+namespace __detail {
+template<class T>
+constexpr bool __is_join_atom = false;
+
+template<class V, size_t... Vars>
+constexpr bool __is_join_atom<join_atom<V, Vars...>> = true;
+
+// Where variable Var occurs: the atoms that bind it and the column each binds it in.
+struct __atom_binding {
+  size_t atom;
+  size_t column;
+};
+
+template<size_t Var, class... Atoms>
+inline constexpr auto __atom_bindings = [] {
+  pair<array<__atom_binding, sizeof...(Atoms)>, size_t> result{};
+  template for (constexpr size_t A : views::indices(sizeof...(Atoms))) {
+    for (size_t column = 0; column != Atoms...[A]::variables.size(); ++column)
+      if (Atoms...[A]::variables[column] == Var)
+        result.first[result.second++] = {A, column};
+  }
+  return result;
+}();
+
+template<class... Atoms>
+inline constexpr size_t __variable_count = ranges::max({Atoms::variables.back()...}) + 1;
+
+template<class... Atoms>
+concept __binds_every_variable = []<size_t... Var>(index_sequence<Var...>) {
+  return ((__atom_bindings<Var, Atoms...>.second != 0) && ...);
+}(make_index_sequence<__variable_count<Atoms...>>());
+
+// The rows of an atom that match the values bound so far: first[c] and last[c] delimit the rows
+// agreeing on every bound column before c, and next[c] is where the search for the run of the
+// next value of column c resumes.
+template<class Atom>
+struct __trie_path {
+  using iterator = iterator_t<Atom>;
+  array<iterator, Atom::variables.size()> first{};
+  array<iterator, Atom::variables.size()> last{};
+  array<iterator, Atom::variables.size()> next{};
+};
+
+// The intersection that binds variable Var: one trie level of every atom binding it.
+template<class Comp, size_t Var, class Seq, class... Atoms>
+struct __leapfrog_level;
+
+template<class Comp, size_t Var, size_t... J, class... Atoms>
+struct __leapfrog_level<Comp, Var, index_sequence<J...>, Atoms...> {
+  static constexpr auto bindings = __atom_bindings<Var, Atoms...>;
+  using type = set_intersection_view<
+    Comp, identity,
+    __trie_level<Comp, iterator_t<Atoms...[bindings.first[J].atom]>, bindings.first[J].column>...>;
+};
+
+template<class Comp, size_t Var, class... Atoms>
+using __leapfrog_level_t = __leapfrog_level<
+  Comp, Var, make_index_sequence<__atom_bindings<Var, Atoms...>.second>, Atoms...>::type;
+
+// The intersection for one variable and its cursor, which points at the value bound to it.
+template<class View>
+struct __leapfrog_frame {
+  optional<View> view;
+  iterator_t<View> current;
+};
+
+template<class Comp, class Seq, class... Atoms>
+struct __leapfrog_levels;
+
+template<class Comp, size_t... Var, class... Atoms>
+struct __leapfrog_levels<Comp, index_sequence<Var...>, Atoms...> {
+  using frames = tuple<__leapfrog_frame<__leapfrog_level_t<Comp, Var, Atoms...>>...>;
+  using reference = tuple<range_reference_t<__leapfrog_level_t<Comp, Var, Atoms...>>...>;
+  using value_type = tuple<range_value_t<__leapfrog_level_t<Comp, Var, Atoms...>>...>;
+};
+}  // namespace __detail
+
+// A worst-case optimal join of sorted relations, such as the adjacency arrays of a graph, by the
+// leapfrog triejoin algorithm. Each atom binds some of the query variables; the view binds them
+// one at a time in order, intersecting the values every atom binding a variable allows given
+// the values already bound, and yields a tuple of the values of all variables for each match.
+//
+// Each variable is bound by a set_intersection_view over trie levels of its atoms, whose cursors
+// seek rather than step, so the join never builds an intermediate result. The state of the join
+// lives in the view: begin() starts it over, and the view must not move while it is iterated.
+template<class Comp, class... Atoms>
+  requires(sizeof...(Atoms) > 0) && is_object_v<Comp> && (__detail::__is_join_atom<Atoms> && ...) &&
+  __detail::__binds_every_variable<Atoms...>
+class leapfrog_join_view : public view_interface<leapfrog_join_view<Comp, Atoms...>> {
+  static constexpr size_t variables = __detail::__variable_count<Atoms...>;  // exposition only
+  using levels = __detail::__leapfrog_levels<Comp, make_index_sequence<variables>,
+                                             Atoms...>;  // exposition only
+
+  [[no_unique_address]] __detail::__box<Comp> comp_;  // exposition only
+  tuple<Atoms...> atoms_;                             // exposition only
+  tuple<__detail::__trie_path<Atoms>...> paths_;      // exposition only
+  typename levels::frames frames_;                    // exposition only
+  size_t depth_ = 0;                                  // exposition only
+  bool done_ = true;                                  // exposition only
+
+  // Starts the intersection for variable Var over the rows each of its atoms has left.
+  template<size_t Var>
+  constexpr void
+  open() {  // exposition only
+    constexpr auto bindings = __detail::__atom_bindings<Var, Atoms...>;
+    auto& frame = std::get<Var>(frames_);
+    [&]<size_t... J>(index_sequence<J...>) {
+      frame.view.emplace(*comp_, level<bindings.first[J].atom, bindings.first[J].column>()...);
+    }(make_index_sequence<bindings.second>());
+    frame.current = frame.view->begin();
+  }
+
+  template<size_t A, size_t Column>
+  constexpr auto
+  level() {  // exposition only
+    auto& path = std::get<A>(paths_);
+    path.next[Column] = path.first[Column];
+    return __detail::__trie_level<Comp, typename __detail::__trie_path<Atoms...[A]>::iterator,
+                                  Column>(path.first[Column], path.last[Column],
+                                          std::addressof(*comp_));
+  }
+
+  // Narrows every atom binding Var to the rows holding the value just bound to it.
+  template<size_t Var>
+  constexpr void
+  descend() {  // exposition only
+    constexpr auto bindings = __detail::__atom_bindings<Var, Atoms...>;
+    auto&& value = *std::get<Var>(frames_).current;
+    template for (constexpr size_t J : views::indices(bindings.second)) {
+      constexpr size_t A = bindings.first[J].atom;
+      constexpr size_t Column = bindings.first[J].column;
+      if constexpr (Column + 1 < Atoms...[A]::variables.size()) {
+        auto& path = std::get<A>(paths_);
+        path.first[Column + 1] = __detail::__gallop_partition_point(
+          path.next[Column], path.last[Column], [&](auto&& row) {
+            return __detail::__set_less(*comp_, std::get<Column>(row), value);
+          });
+        path.last[Column + 1] = __detail::__gallop_partition_point(
+          path.first[Column + 1], path.last[Column], [&](auto&& row) {
+            return !__detail::__set_less(*comp_, value, std::get<Column>(row));
+          });
+        path.next[Column] = path.last[Column + 1];
+      }
+    }
+  }
+
+  // Binds variables depth first until every one holds a value, backing up a variable whenever
+  // the intersection for the one after it runs out.
+  constexpr void
+  satisfy() {  // exposition only
+    while (true) {
+      const bool exhausted = __detail::__visit_index<variables>(
+        depth_, [this]<size_t Var> { return std::get<Var>(frames_).current == default_sentinel; });
+      if (exhausted) {
+        if (depth_ == 0) {
+          done_ = true;
+          return;
+        }
+        --depth_;
+        __detail::__visit_index<variables>(
+          depth_, [this]<size_t Var> { ++std::get<Var>(frames_).current; });
+        continue;
+      }
+      if (depth_ == variables - 1)
+        return;
+      __detail::__visit_index<variables>(depth_, [this]<size_t Var> {
+        if constexpr (Var + 1 < variables) {
+          descend<Var>();
+          open<Var + 1>();
+        }
+      });
+      ++depth_;
+    }
+  }
+
+  class iterator {
+    friend leapfrog_join_view;
+
+    leapfrog_join_view* parent_ = nullptr;
+
+    constexpr explicit iterator(leapfrog_join_view* parent) : parent_(parent) { }
+
+   public:
+    using iterator_concept = input_iterator_tag;
+    using value_type = typename levels::value_type;
+    using difference_type = ptrdiff_t;
+
+    iterator(const iterator&) = delete;
+    iterator(iterator&&) = default;
+    iterator& operator=(const iterator&) = delete;
+    iterator& operator=(iterator&&) = default;
+
+    constexpr typename levels::reference
+    operator*() const {
+      return [this]<size_t... Var>(index_sequence<Var...>) {
+        return typename levels::reference(*std::get<Var>(parent_->frames_).current...);
+      }(make_index_sequence<variables>());
+    }
+
+    constexpr iterator&
+    operator++() {
+      ++std::get<variables - 1>(parent_->frames_).current;
+      parent_->satisfy();
+      return *this;
+    }
+
+    constexpr void
+    operator++(int) {
+      ++*this;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, default_sentinel_t) {
+      return x.parent_->done_;
+    }
+  };  // exposition only
+
+ public:
+  leapfrog_join_view()
+    requires default_initializable<Comp> && (default_initializable<Atoms> && ...)
+  = default;
+
+  constexpr explicit leapfrog_join_view(Comp comp, Atoms... atoms)
+    : comp_(std::move(comp)), atoms_(std::move(atoms)...) {
+    // __glibcxx_assert((ranges::is_sorted(atoms.base()) && ...));
+  }
+
+  constexpr iterator
+  begin() {
+    template for (constexpr size_t A : views::indices(sizeof...(Atoms))) {
+      auto& atom = std::get<A>(atoms_);
+      auto& path = std::get<A>(paths_);
+      path.first[0] = ranges::begin(atom);
+      path.last[0] = path.first[0] + ranges::distance(atom);
+    }
+    depth_ = 0;
+    done_ = false;
+    open<0>();
+    satisfy();
+    return iterator(this);
+  }
+
+  constexpr default_sentinel_t
+  end() const noexcept {
+    return default_sentinel;
+  }
+};
+
+template<class Comp, class... Atoms>
+leapfrog_join_view(Comp, Atoms...) -> leapfrog_join_view<Comp, Atoms...>;
+
+namespace views {
+template<size_t... Vars>
+struct JoinAtom {
+  template<viewable_range R>
+    requires requires { typename ranges::join_atom<views::all_t<R>, Vars...>; }
+  constexpr auto
+  operator() [[nodiscard]] (R&& r) const {
+    return ranges::join_atom<views::all_t<R>, Vars...>(views::all(std::forward<R>(r)));
+  }
+};
+
+// join_atom<vars...>(r): the relation r, whose leading columns bind the query variables vars.
+template<size_t... Vars>
+inline constexpr JoinAtom<Vars...> join_atom;
+
+namespace __detail {
+template<class Comp, class... Atoms>
+concept __can_leapfrog_join_view =
+  requires { leapfrog_join_view(std::declval<Comp>(), std::declval<Atoms>()...); };
+}  // namespace __detail
+
+struct LeapfrogJoinBy {
+  template<class Comp, class... Atoms>
+    requires __detail::__can_leapfrog_join_view<Comp, Atoms...>
+  constexpr auto
+  operator() [[nodiscard]] (Comp&& comp, Atoms&&... atoms) const {
+    return leapfrog_join_view(std::forward<Comp>(comp), std::forward<Atoms>(atoms)...);
+  }
+};
+
+inline constexpr LeapfrogJoinBy leapfrog_join_by;
+
+// leapfrog_join(join_atom<0, 1>(edges), join_atom<1, 2>(edges), join_atom<0, 2>(edges)) lists
+// the triangles a < b < c of a graph whose sorted edge list holds each edge as (min, max).
+struct LeapfrogJoin {
+  template<class... Atoms>
+    requires __detail::__can_leapfrog_join_view<ranges::less, Atoms...>
+  constexpr auto
+  operator() [[nodiscard]] (Atoms&&... atoms) const {
+    return leapfrog_join_view(ranges::less{}, std::forward<Atoms>(atoms)...);
+  }
+};
+
+inline constexpr LeapfrogJoin leapfrog_join;
+}  // namespace views
+
+}  // namespace std::ranges
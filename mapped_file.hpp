@@ -0,0 +1,252 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <compare>
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace std::ranges {
+namespace __detail {
+// A read-only mapping of a whole file, shared by the copies of a mapped_file_view. The kernel is
+// told up front that the file will be read in order, and cursors report their progress so that
+// each time one passes the window read so far, the next window is requested ahead of it. Cursors
+// on several threads may report at once, so the window's end only moves by compare-exchange.
+class __mapped_region {
+  const byte* data_ = nullptr;
+  size_t size_ = 0;
+  atomic<const byte*> horizon_ = nullptr;  // where the window last requested ends
+
+  [[noreturn]] static void
+  fail(const char* what) {
+    throw system_error(errno, system_category(), what);
+  }
+
+ public:
+  static constexpr size_t window = size_t(1) << 22;
+
+  explicit __mapped_region(const filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+      fail("open");
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+      const int error = errno;
+      ::close(fd);
+      errno = error;
+      fail("fstat");
+    }
+    size_ = size_t(st.st_size);
+    if (size_ != 0) {
+      void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        fail("mmap");
+      }
+      data_ = static_cast<const byte*>(p);
+      horizon_.store(data_, memory_order_relaxed);
+      ::madvise(p, size_, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+  }
+
+  __mapped_region(const __mapped_region&) = delete;
+  __mapped_region& operator=(const __mapped_region&) = delete;
+
+  ~__mapped_region() {
+    if (size_ != 0)
+      ::munmap(const_cast<byte*>(data_), size_);
+  }
+
+  const byte*
+  data() const noexcept {
+    return data_;
+  }
+
+  size_t
+  size() const noexcept {
+    return size_;
+  }
+
+  // Called by a cursor that has moved to p. Once p reaches the end of the last window requested,
+  // asks for the window starting at p's page.
+  void
+  advance(const void* p) {
+    const byte* position = static_cast<const byte*>(p);
+    const byte* horizon = horizon_.load(memory_order_relaxed);
+    if (position < horizon)
+      return;
+    const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+    const byte* first = data_ + size_t(position - data_) / page * page;
+    if (first >= data_ + size_)
+      return;
+    const byte* last = first + ranges::min(window, size_t(data_ + size_ - first));
+    // Of the cursors that pass the horizon together, the one that moves it makes the request.
+    while (position >= horizon)
+      if (horizon_.compare_exchange_weak(horizon, last, memory_order_relaxed)) {
+        ::madvise(const_cast<byte*>(first), size_t(last - first), MADV_WILLNEED);
+        return;
+      }
+  }
+};
+}  // namespace __detail
+
+// The records of a file of fixed-width, trivially copyable T, mapped read-only rather than read
+// into memory. Its iterators are contiguous, so the set views keep their vector kernels and
+// galloping; as they advance they ask the kernel to read ahead of them. Copies share the mapping,
+// which is released with the last of them. A partial record at the end of the file is ignored.
+template<class T>
+  requires is_object_v<T> && is_trivially_copyable_v<T>
+class mapped_file_view : public view_interface<mapped_file_view<T>> {
+  shared_ptr<__detail::__mapped_region> region_;  // exposition only
+
+  class iterator {
+    friend mapped_file_view;
+
+    const T* ptr_ = nullptr;
+    __detail::__mapped_region* region_ = nullptr;
+
+    constexpr iterator(const T* ptr, __detail::__mapped_region* region)
+      : ptr_(ptr), region_(region) { }
+
+    void
+    note_progress() {
+      region_->advance(ptr_);
+    }
+
+   public:
+    using iterator_concept = contiguous_iterator_tag;
+    using iterator_category = random_access_iterator_tag;
+    using value_type = remove_cv_t<T>;
+    using difference_type = ptrdiff_t;
+
+    iterator() = default;
+
+    constexpr const T&
+    operator*() const noexcept {
+      return *ptr_;
+    }
+
+    constexpr const T*
+    operator->() const noexcept {
+      return ptr_;
+    }
+
+    constexpr const T&
+    operator[](difference_type n) const noexcept {
+      return ptr_[n];
+    }
+
+    iterator&
+    operator++() {
+      ++ptr_;
+      note_progress();
+      return *this;
+    }
+
+    iterator
+    operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    constexpr iterator&
+    operator--() noexcept {
+      --ptr_;
+      return *this;
+    }
+
+    constexpr iterator
+    operator--(int) noexcept {
+      auto tmp = *this;
+      --ptr_;
+      return tmp;
+    }
+
+    // Only a cursor moving forward reports, from where it lands.
+    iterator&
+    operator+=(difference_type n) {
+      ptr_ += n;
+      if (n > 0)
+        note_progress();
+      return *this;
+    }
+
+    iterator&
+    operator-=(difference_type n) {
+      return *this += -n;
+    }
+
+    // Probes such as a gallop's land far ahead of where a cursor will read next, so the
+    // iterators these make do not report.
+    friend constexpr iterator
+    operator+(const iterator& it, difference_type n) noexcept {
+      return iterator(it.ptr_ + n, it.region_);
+    }
+
+    friend constexpr iterator
+    operator+(difference_type n, const iterator& it) noexcept {
+      return iterator(it.ptr_ + n, it.region_);
+    }
+
+    friend constexpr iterator
+    operator-(const iterator& it, difference_type n) noexcept {
+      return iterator(it.ptr_ - n, it.region_);
+    }
+
+    friend constexpr difference_type
+    operator-(const iterator& x, const iterator& y) noexcept {
+      return x.ptr_ - y.ptr_;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y) noexcept {
+      return x.ptr_ == y.ptr_;
+    }
+
+    friend constexpr strong_ordering
+    operator<=>(const iterator& x, const iterator& y) noexcept {
+      return x.ptr_ <=> y.ptr_;
+    }
+  };
+
+ public:
+  mapped_file_view() = default;
+
+  explicit mapped_file_view(const filesystem::path& path)
+    : region_(make_shared<__detail::__mapped_region>(path)) { }
+
+  const T*
+  data() const noexcept {
+    return region_ ? reinterpret_cast<const T*>(region_->data()) : nullptr;
+  }
+
+  size_t
+  size() const noexcept {
+    return region_ ? region_->size() / sizeof(T) : 0;
+  }
+
+  iterator
+  begin() const noexcept {
+    return iterator(data(), region_.get());
+  }
+
+  iterator
+  end() const noexcept {
+    return iterator(data() + size(), region_.get());
+  }
+};
+}  // namespace std::ranges
@@ -0,0 +1,258 @@
+#pragma once
+#include <ranges>
+#include <tuple>
+
+#include "concepts.h"
+
+namespace std::ranges {
+// Joins sorted views on equal keys. For every key held by all of them, yields a tuple of
+// references to one element of each view, running through the cross product of the elements
+// each view holds for that key with the last view varying fastest.
+template<class Comp, class Proj, forward_range... Views>
+  requires(view<Views> && ...) && (sizeof...(Views) > 0) && is_object_v<Comp> &&
+  is_object_v<Proj> && __detail::__pairwise_projected_set_order<Comp, Proj, Views...>
+class merge_join_view : public view_interface<merge_join_view<Comp, Proj, Views...>> {
+  [[no_unique_address]] __detail::__box<Comp> comp_;  // exposition only
+  [[no_unique_address]] __detail::__box<Proj> proj_;  // exposition only
+  [[no_unique_address]] tuple<Views...> views_;       // exposition only
+
+  class iterator {
+    friend merge_join_view;
+
+    // current_ runs like an odometer over [group_begin_, group_end_) of every view. The keys are
+    // those at group_begin_, which all compare equal.
+    tuple<iterator_t<Views>...> current_;      // exposition only
+    tuple<iterator_t<Views>...> group_begin_;  // exposition only
+    tuple<iterator_t<Views>...> group_end_;    // exposition only
+    tuple<sentinel_t<Views>...> end_;          // exposition only
+    [[no_unique_address]] tuple<
+      __detail::__key_cache<Proj, iterator_t<Views>>...> keys_;  // exposition only
+    merge_join_view* parent_ = nullptr;
+
+    template<size_t N>
+    constexpr void
+    refresh() {  // exposition only
+      std::get<N>(keys_).refresh(*parent_->proj_, std::get<N>(current_), std::get<N>(end_));
+    }
+
+    template<size_t N>
+    constexpr decltype(auto)
+    key() const {  // exposition only
+      return std::get<N>(keys_).get(std::get<N>(current_));
+    }
+
+    // Brings every cursor to the same key, as set_intersection_view does, or one of them to its
+    // end. Returns false when the first cursor moved and the others must be checked again.
+    constexpr bool
+    try_align() {  // exposition only
+      auto& first = std::get<0>(current_);
+      if (first == std::get<0>(end_))
+        return true;
+
+      template for (constexpr size_t N : views::iota(1uz, sizeof...(Views))) {
+        auto& other = std::get<N>(current_);
+        while (true) {
+          if (other == std::get<N>(end_))
+            return true;
+          const weak_ordering order = __detail::__set_compare(*parent_->comp_, key<0>(), key<N>());
+          if (order < 0) {
+            __detail::__seek_to(*parent_->comp_, *parent_->proj_, first, std::get<0>(end_),
+                                key<N>());
+            refresh<0>();
+            return false;
+          }
+          if (order > 0) {
+            __detail::__seek_to(*parent_->comp_, *parent_->proj_, other, std::get<N>(end_),
+                                key<0>());
+            refresh<N>();
+          } else
+            break;
+        }
+      }
+      return true;
+    }
+
+    // Finds the next key held by every view and the extent of its elements in each.
+    constexpr void
+    satisfy() {  // exposition only
+      while (!try_align())
+        ;
+      if (*this == default_sentinel)
+        return;
+      group_begin_ = current_;
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        const auto in_group = [&](auto&& x) {
+          return !__detail::__set_less(*parent_->comp_, key<0>(),
+                                       std::__invoke(*parent_->proj_, x));
+        };
+        auto& last = std::get<N>(group_end_);
+        if constexpr (__detail::__gallopable<Views...[N]>)
+          last = __detail::__gallop_partition_point(std::get<N>(current_), std::get<N>(end_),
+                                                    in_group);
+        else {
+          last = std::get<N>(current_);
+          do
+            ++last;
+          while (last != std::get<N>(end_) && in_group(*last));
+        }
+      }
+    }
+
+    constexpr explicit iterator(merge_join_view* parent, tuple<iterator_t<Views>...> current)
+      : parent_(parent),
+        current_(std::move(current)),
+        end_(__detail::__tuple_transform(ranges::end, parent->views_)) {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
+      satisfy();
+    }
+
+   public:
+    using iterator_concept = forward_iterator_tag;
+    using value_type = tuple<range_value_t<Views>...>;
+    using difference_type = common_type_t<range_difference_t<Views>...>;
+
+    iterator()
+      requires(default_initializable<iterator_t<Views>> && ...)
+    = default;
+
+    constexpr tuple<range_reference_t<Views>...>
+    operator*() const {
+      return __detail::__tuple_transform([](auto& it) -> decltype(auto) { return *it; },
+                                         current_);
+    }
+
+    constexpr iterator&
+    operator++() {
+      bool wrapped = true;
+      template for (constexpr size_t I : views::indices(sizeof...(Views))) {
+        constexpr size_t N = sizeof...(Views) - 1 - I;
+        if (wrapped) {
+          auto& it = std::get<N>(current_);
+          if (++it == std::get<N>(group_end_))
+            it = std::get<N>(group_begin_);
+          else
+            wrapped = false;
+        }
+      }
+      if (wrapped) {
+        current_ = group_end_;
+        template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+          refresh<N>();
+        }
+        satisfy();
+      }
+      return *this;
+    }
+
+    constexpr iterator
+    operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    // Moves to the first match whose key is not less than target, skipping ahead in every input
+    // rather than stepping through the elements in between.
+    template<class Key>
+      requires(__detail::__set_order<Comp&, __detail::__key_reference_t<Proj, iterator_t<Views>>,
+                                     const Key&> &&
+               ...)
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel || !__detail::__set_less(*parent_->comp_, key<0>(), target))
+        return;
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      }
+      satisfy();
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y) {
+      return x.current_ == y.current_;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& it, default_sentinel_t) {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        if (std::get<N>(it.current_) == std::get<N>(it.end_))
+          return true;
+      }
+      return false;
+    }
+
+    friend constexpr tuple<range_rvalue_reference_t<Views>...>
+    iter_move(const iterator& i) {
+      return __detail::__tuple_transform(ranges::iter_move, i.current_);
+    }
+  };  // exposition only
+
+  [[no_unique_address]] __detail::__non_propagating_cache<iterator> begin_;  // exposition only
+
+ public:
+  merge_join_view() = default;
+
+  constexpr explicit merge_join_view(Comp comp, Views... bases)
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...) { }
+
+  constexpr explicit merge_join_view(Comp comp, Proj proj, Views... bases)
+    : comp_(std::move(comp)), proj_(std::move(proj)), views_(std::move(bases)...) {
+    // __glibcxx_assert((ranges::is_sorted(bases, *comp_, *proj_) && ...));
+  }
+
+  constexpr iterator
+  begin() {
+    if (!begin_._M_has_value())
+      begin_._M_emplace(iterator(this, __detail::__tuple_transform(ranges::begin, views_)));
+    return *begin_;
+  }
+
+  constexpr default_sentinel_t
+  end() const noexcept {
+    return default_sentinel;
+  }
+};
+
+template<class Comp, class... Rs>
+merge_join_view(Comp, Rs&&...) -> merge_join_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!range<Proj>)
+merge_join_view(Comp, Proj, Rs&&...) -> merge_join_view<Comp, Proj, views::all_t<Rs>...>;
+
+namespace views {
+namespace __detail {
+template<class Comp, class... Args>
+concept __can_merge_join_view =
+  requires { merge_join_view(std::declval<Comp>(), std::declval<Args>()...); };
+}  // namespace __detail
+
+struct MergeJoinBy {
+  template<class Comp, class... Args>
+    requires __detail::__can_merge_join_view<Comp, Args...>
+  constexpr auto
+  operator() [[nodiscard]] (Comp&& comp, Args&&... args) const {
+    return merge_join_view(std::forward<Comp>(comp), std::forward<Args>(args)...);
+  }
+};
+
+inline constexpr MergeJoinBy merge_join_by;
+
+struct MergeJoin {
+  template<class... Rs>
+    requires __detail::__can_merge_join_view<ranges::less, Rs...>
+  constexpr auto
+  operator() [[nodiscard]] (Rs&&... rs) const {
+    return merge_join_view(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr MergeJoin merge_join;
+}  // namespace views
+
+}  // namespace std::ranges
@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <ranges>
+#include <span>
+#include <utility>
+
+namespace std::ranges::__detail {
+
+// Above this many inputs the K-way views order their cursors with a __tournament_tree instead of
+// rescanning every cursor per element; below it the linear scan touches less memory and wins.
+// The value is a tuning estimate, not a measured constant; retune it for the target.
+inline constexpr size_t __merge_tree_threshold = 12;
+
+// Calls f.template operator()<I>() for the runtime index i through a table of function pointers,
+// so the dispatch costs one indirect call however many alternatives there are.
+template<size_t K, class F>
+constexpr decltype(auto)
+__visit_index(size_t i, F&& f) {
+  using R = decltype(f.template operator()<0>());
+  constexpr auto table = []<size_t... Ns>(index_sequence<Ns...>) {
+    return array<R (*)(F&), K>{[](F& g) -> R { return g.template operator()<Ns>(); }...};
+  }(make_index_sequence<K>{});
+  return table[i](f);
+}
+
+// A winner tree over K cursors: node_[p] holds the best cursor below internal node p, so moving
+// one cursor replays a single leaf-to-root path, one comparison per level. `less(i, j)` decides
+// whether cursor i is ahead of cursor j; it must rank exhausted cursors last and break ties by
+// index so that equal keys surface in input order.
+//
+// Cursors tied with the winner can be held out of the competition as a group, which lets a view
+// take exactly one element from every input holding the current key before advancing them.
+template<size_t K>
+class __tournament_tree {
+  array<size_t, K> node_{};
+  array<size_t, K> group_{};
+  array<bool, K> held_{};
+  size_t group_size_ = 0;
+
+  template<class Less>
+  constexpr bool
+  beats(size_t i, size_t j, Less& less) const {
+    if (held_[i])
+      return false;
+    if (held_[j])
+      return true;
+    return less(i, j);
+  }
+
+  template<class Less>
+  constexpr void
+  play(size_t p, Less& less) {
+    size_t l = 2 * p >= K ? 2 * p - K : node_[2 * p];
+    size_t r = 2 * p + 1 >= K ? 2 * p + 1 - K : node_[2 * p + 1];
+    node_[p] = beats(r, l, less) ? r : l;
+  }
+
+  template<class Less>
+  constexpr void
+  update(size_t i, Less& less) {
+    for (size_t p = (K + i) / 2; p > 0; p /= 2)
+      play(p, less);
+  }
+
+ public:
+  template<class Less>
+  constexpr void
+  build(Less less) {
+    for (size_t p = K - 1; p > 0; --p)
+      play(p, less);
+  }
+
+  constexpr size_t
+  top() const noexcept {
+    return K == 1 ? 0 : node_[1];
+  }
+
+  constexpr span<const size_t>
+  group() const noexcept {
+    return span(group_.data(), group_size_);
+  }
+
+  // Holds out the winner and then every cursor for which tied(i) is true as it reaches the top.
+  // tied must reject exhausted cursors.
+  template<class Less, class Tied>
+  constexpr void
+  gather(Less less, Tied tied) {
+    group_size_ = 0;
+    size_t w = top();
+    do {
+      group_[group_size_++] = w;
+      held_[w] = true;
+      update(w, less);
+      w = top();
+    } while (!held_[w] && tied(w));
+  }
+
+  // Drops the held group and replays every match, for when any of the cursors may have moved.
+  template<class Less>
+  constexpr void
+  reset(Less less) {
+    held_ = {};
+    group_size_ = 0;
+    build(std::move(less));
+  }
+
+  // Lets every held cursor compete again after next(i) has stepped it past the group's key.
+  template<class Less, class Next>
+  constexpr void
+  release(Less less, Next next) {
+    for (size_t i : group()) {
+      held_[i] = false;
+      next(i);
+      update(i, less);
+    }
+    group_size_ = 0;
+  }
+};
+
+}  // namespace std::ranges::__detail
@@ -0,0 +1,187 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "concepts.h"
+
+namespace std::ranges {
+// A sorted list of 32-bit ids compressed in blocks of block_size: each id is stored as the varint
+// encoded gap from the id before it, and each block records its greatest id and where its bytes
+// start. A cursor decodes a block only when it reaches it, and seek() passes over every block
+// whose greatest id is below the target without decoding it. The set views seek their inputs
+// when one falls behind, so intersections and differences over posting lists skip whole blocks.
+class posting_list {
+ public:
+  static constexpr size_t block_size = 128;
+
+ private:
+  vector<uint8_t> bytes_;        // exposition only
+  vector<uint32_t> block_max_;   // exposition only
+  vector<size_t> block_offset_;  // exposition only
+  size_t size_ = 0;              // exposition only
+
+  static constexpr void
+  put_varint(vector<uint8_t>& out, uint32_t value) {  // exposition only
+    for (; value >= 0x80; value >>= 7)
+      out.push_back(uint8_t(value | 0x80));
+    out.push_back(uint8_t(value));
+  }
+
+  // Decodes block b into out and returns how many ids it holds.
+  constexpr size_t
+  decode(size_t b, uint32_t* out) const {  // exposition only
+    const uint8_t* p = bytes_.data() + block_offset_[b];
+    const size_t n = ranges::min(block_size, size_ - b * block_size);
+    uint32_t id = b == 0 ? 0 : block_max_[b - 1];
+    for (size_t i = 0; i != n; ++i) {
+      uint32_t gap = 0;
+      for (int shift = 0;; shift += 7) {
+        const uint8_t byte = *p++;
+        gap |= uint32_t(byte & 0x7f) << shift;
+        if (byte < 0x80)
+          break;
+      }
+      id += gap;
+      out[i] = id;
+    }
+    return n;
+  }
+
+  class iterator {
+    friend posting_list;
+
+    const posting_list* parent_ = nullptr;
+    size_t block_ = 0;
+    size_t pos_ = 0;
+    size_t count_ = 0;
+    array<uint32_t, block_size> ids_{};  // the decoded ids of block_
+
+    constexpr void
+    load(size_t block) {
+      block_ = block;
+      pos_ = 0;
+      count_ = block_ == parent_->block_max_.size() ? 0 : parent_->decode(block_, ids_.data());
+    }
+
+    constexpr iterator(const posting_list* parent, size_t block) : parent_(parent) {
+      load(block);
+    }
+
+   public:
+    using iterator_concept = forward_iterator_tag;
+    using iterator_category = forward_iterator_tag;
+    using value_type = uint32_t;
+    using difference_type = ptrdiff_t;
+
+    iterator() = default;
+
+    constexpr uint32_t
+    operator*() const {
+      return ids_[pos_];
+    }
+
+    constexpr iterator&
+    operator++() {
+      if (++pos_ == count_)
+        load(block_ + 1);
+      return *this;
+    }
+
+    constexpr iterator
+    operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    // Moves to the first id not less than target. Blocks whose greatest id is less than target
+    // are skipped by galloping over the block maxima, and only the block landed on is decoded.
+    // Ids are compared with target in its own type, so a key that does not fit in 32 bits, or is
+    // not integral, is never narrowed into one below it.
+    template<class Key>
+      requires totally_ordered_with<uint32_t, const Key&>
+    constexpr void
+    seek(const Key& target) {
+      const auto below = [&](uint32_t id) { return id < target; };
+      if (count_ == 0 || !below(ids_[pos_]))
+        return;
+      const auto& block_max = parent_->block_max_;
+      if (below(block_max[block_])) {
+        const auto next = __detail::__gallop_partition_point(block_max.begin() + block_ + 1,
+                                                             block_max.end(), below);
+        load(next - block_max.begin());
+        if (count_ == 0)
+          return;
+      }
+      pos_ = ranges::partition_point(ids_.begin() + pos_, ids_.begin() + count_, below) -
+        ids_.begin();
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y) {
+      return x.block_ == y.block_ && x.pos_ == y.pos_;
+    }
+  };
+
+ public:
+  posting_list() = default;
+
+  template<input_range R>
+    requires convertible_to<range_reference_t<R>, uint32_t>
+  constexpr posting_list(from_range_t, R&& ids) {
+    for (auto&& id : ids)
+      push_back(id);
+  }
+
+  // Appends id, which must not be less than the last id.
+  constexpr void
+  push_back(uint32_t id) {
+    // __glibcxx_assert(size_ == 0 || block_max_.back() <= id);
+    const uint32_t previous = size_ == 0 ? 0 : block_max_.back();
+    if (size_ % block_size == 0) {
+      block_offset_.push_back(bytes_.size());
+      block_max_.push_back(id);
+    } else
+      block_max_.back() = id;
+    put_varint(bytes_, id - previous);
+    ++size_;
+  }
+
+  constexpr size_t
+  size() const noexcept {
+    return size_;
+  }
+
+  constexpr bool
+  empty() const noexcept {
+    return size_ == 0;
+  }
+
+  // The greatest id of each block.
+  constexpr span<const uint32_t>
+  block_max() const noexcept {
+    return block_max_;
+  }
+
+  // The size of the encoded ids in bytes.
+  constexpr size_t
+  encoded_size() const noexcept {
+    return bytes_.size();
+  }
+
+  constexpr iterator
+  begin() const {
+    return iterator(this, 0);
+  }
+
+  constexpr iterator
+  end() const {
+    return iterator(this, block_max_.size());
+  }
+};
+}  // namespace std::ranges
@@ -0,0 +1,671 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <tuple>
+#include <vector>
+
+namespace std::ranges {
+namespace __detail {
+// One 64K chunk of a roaring_bitmap: the low 16 bits of the values sharing the chunk's high bits,
+// held in whichever form suits their density. Sparse chunks are a sorted array, dense ones a
+// bitset of 1024 words, and clustered ones, after run_optimize(), a list of runs. Operations on
+// two chunks merge or probe arrays when the result stays sparse and otherwise combine the chunks
+// a word at a time.
+class __roaring_container {
+ public:
+  enum class kind : unsigned char { array, bitmap, run };
+
+  static constexpr uint32_t end_value = uint32_t(1) << 16;
+  static constexpr size_t array_limit = 4096;  // past this many values a bitmap is smaller
+  static constexpr size_t word_count = end_value / 64;
+  using words_type = array<uint64_t, word_count>;
+
+ private:
+  kind kind_ = kind::array;
+  uint32_t cardinality_ = 0;
+  // An array's values, or the first and last value of each run of a run container.
+  vector<uint16_t> values_;
+  vector<uint64_t> words_;  // a bitmap's bits
+
+  static constexpr void
+  set_range(words_type& words, uint32_t first, uint32_t last) {
+    const size_t first_word = first / 64;
+    const size_t last_word = last / 64;
+    const uint64_t first_mask = ~uint64_t(0) << (first % 64);
+    const uint64_t last_mask = ~uint64_t(0) >> (63 - last % 64);
+    if (first_word == last_word) {
+      words[first_word] |= first_mask & last_mask;
+      return;
+    }
+    words[first_word] |= first_mask;
+    for (size_t i = first_word + 1; i != last_word; ++i)
+      words[i] = ~uint64_t(0);
+    words[last_word] |= last_mask;
+  }
+
+  constexpr uint32_t
+  next_set_bit(uint32_t from) const {
+    if (from >= end_value)
+      return end_value;
+    size_t i = from / 64;
+    uint64_t word = words_[i] & (~uint64_t(0) << (from % 64));
+    while (word == 0) {
+      if (++i == word_count)
+        return end_value;
+      word = words_[i];
+    }
+    return uint32_t(i * 64 + countr_zero(word));
+  }
+
+  // Takes the values set in words, as an array or a bitmap by how many there are.
+  constexpr void
+  assign_words(const words_type& words) {
+    cardinality_ = 0;
+    for (uint64_t word : words)
+      cardinality_ += popcount(word);
+    if (cardinality_ > array_limit) {
+      kind_ = kind::bitmap;
+      words_.assign(words.begin(), words.end());
+      values_ = vector<uint16_t>();
+      return;
+    }
+    kind_ = kind::array;
+    words_ = vector<uint64_t>();
+    values_.clear();
+    values_.reserve(cardinality_);
+    for (size_t i = 0; i != word_count; ++i)
+      for (uint64_t word = words[i]; word != 0; word &= word - 1)
+        values_.push_back(uint16_t(i * 64 + countr_zero(word)));
+  }
+
+  static constexpr __roaring_container
+  from_array(vector<uint16_t> values) {
+    __roaring_container result;
+    result.cardinality_ = uint32_t(values.size());
+    result.values_ = std::move(values);
+    return result;
+  }
+
+  // Keeps the values of the array a for which keep(value) holds.
+  template<class Pred>
+  static constexpr __roaring_container
+  filter(const __roaring_container& a, Pred keep) {
+    vector<uint16_t> values;
+    ranges::copy_if(a.values_, back_inserter(values), keep);
+    return from_array(std::move(values));
+  }
+
+  template<class WordOp>
+  static constexpr __roaring_container
+  combine(const __roaring_container& a, const __roaring_container& b, WordOp op) {
+    words_type words = a.words();
+    const words_type other = b.words();
+    for (size_t i = 0; i != word_count; ++i)
+      words[i] = op(words[i], other[i]);
+    __roaring_container result;
+    result.assign_words(words);
+    return result;
+  }
+
+ public:
+  constexpr kind
+  form() const noexcept {
+    return kind_;
+  }
+
+  constexpr uint32_t
+  size() const noexcept {
+    return cardinality_;
+  }
+
+  constexpr bool
+  empty() const noexcept {
+    return cardinality_ == 0;
+  }
+
+  constexpr bool
+  contains(uint16_t value) const {
+    if (kind_ == kind::array)
+      return ranges::binary_search(values_, value);
+    if (kind_ == kind::bitmap)
+      return (words_[value / 64] >> (value % 64)) & 1;
+    size_t lo = 0;
+    size_t hi = values_.size() / 2;
+    while (lo != hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (values_[2 * mid + 1] < value)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo != values_.size() / 2 && values_[2 * lo] <= value;
+  }
+
+  constexpr words_type
+  words() const {
+    words_type words{};
+    if (kind_ == kind::bitmap)
+      ranges::copy(words_, words.begin());
+    else if (kind_ == kind::array)
+      for (uint16_t value : values_)
+        words[value / 64] |= uint64_t(1) << (value % 64);
+    else
+      for (size_t i = 0; i != values_.size(); i += 2)
+        set_range(words, values_[i], values_[i + 1]);
+    return words;
+  }
+
+  constexpr void
+  insert(uint16_t value) {
+    if (kind_ == kind::run)
+      assign_words(words());
+    if (kind_ == kind::bitmap) {
+      uint64_t& word = words_[value / 64];
+      const uint64_t bit = uint64_t(1) << (value % 64);
+      cardinality_ += (word & bit) == 0;
+      word |= bit;
+      return;
+    }
+    const auto it = ranges::lower_bound(values_, value);
+    if (it != values_.end() && *it == value)
+      return;
+    if (values_.size() == array_limit) {
+      words_type words = this->words();
+      words[value / 64] |= uint64_t(1) << (value % 64);
+      assign_words(words);
+      return;
+    }
+    values_.insert(it, value);
+    ++cardinality_;
+  }
+
+  // The least value, with pos set up for next(), or end_value when empty.
+  constexpr uint32_t
+  first(size_t& pos) const {
+    pos = 0;
+    if (kind_ == kind::bitmap)
+      return next_set_bit(0);
+    return values_.empty() ? end_value : values_[0];
+  }
+
+  // The value after value, which pos was left at by first() or next(), or end_value.
+  constexpr uint32_t
+  next(size_t& pos, uint32_t value) const {
+    if (kind_ == kind::bitmap)
+      return next_set_bit(value + 1);
+    if (kind_ == kind::run && value != values_[2 * pos + 1])
+      return value + 1;
+    ++pos;
+    if (kind_ == kind::array)
+      return pos != values_.size() ? values_[pos] : end_value;
+    return 2 * pos != values_.size() ? values_[2 * pos] : end_value;
+  }
+
+  // Switches to runs when they take less space than the current form.
+  constexpr void
+  run_optimize() {
+    if (kind_ == kind::run || cardinality_ == 0)
+      return;
+    vector<uint16_t> runs;
+    size_t pos;
+    for (uint32_t value = first(pos); value != end_value; value = next(pos, value)) {
+      if (!runs.empty() && runs.back() + 1u == value)
+        runs.back() = uint16_t(value);
+      else {
+        runs.push_back(uint16_t(value));
+        runs.push_back(uint16_t(value));
+      }
+    }
+    const size_t current = kind_ == kind::array ? values_.size() : 4 * word_count;
+    if (runs.size() < current) {
+      kind_ = kind::run;
+      values_ = std::move(runs);
+      words_ = vector<uint64_t>();
+    }
+  }
+
+  friend constexpr __roaring_container
+  operator&(const __roaring_container& a, const __roaring_container& b) {
+    if (a.kind_ == kind::array)
+      return filter(a, [&](uint16_t value) { return b.contains(value); });
+    if (b.kind_ == kind::array)
+      return filter(b, [&](uint16_t value) { return a.contains(value); });
+    return combine(a, b, bit_and<>{});
+  }
+
+  friend constexpr __roaring_container
+  operator|(const __roaring_container& a, const __roaring_container& b) {
+    if (a.kind_ == kind::array && b.kind_ == kind::array &&
+        a.size() + b.size() <= array_limit) {
+      vector<uint16_t> values;
+      ranges::set_union(a.values_, b.values_, back_inserter(values));
+      return from_array(std::move(values));
+    }
+    return combine(a, b, bit_or<>{});
+  }
+
+  friend constexpr __roaring_container
+  operator-(const __roaring_container& a, const __roaring_container& b) {
+    if (a.kind_ == kind::array)
+      return filter(a, [&](uint16_t value) { return !b.contains(value); });
+    return combine(a, b, [](uint64_t x, uint64_t y) { return x & ~y; });
+  }
+
+  friend constexpr __roaring_container
+  operator^(const __roaring_container& a, const __roaring_container& b) {
+    if (a.kind_ == kind::array && b.kind_ == kind::array &&
+        a.size() + b.size() <= array_limit) {
+      vector<uint16_t> values;
+      ranges::set_symmetric_difference(a.values_, b.values_, back_inserter(values));
+      return from_array(std::move(values));
+    }
+    return combine(a, b, bit_xor<>{});
+  }
+};
+
+struct __roaring_access;
+}  // namespace __detail
+
+// A compressed set of 32-bit integers in the roaring layout: the values are split into 64K chunks
+// by their high 16 bits, and each chunk picks its own representation. It is a sorted forward
+// range, so it can be handed to any set view; when every input of views::set_intersection,
+// set_union, set_difference or set_symmetric_difference is one, the adaptors return a
+// roaring_combine_view, which combines them chunk by chunk instead of merging element by element.
+class roaring_bitmap {
+  friend __detail::__roaring_access;
+
+  using container = __detail::__roaring_container;  // exposition only
+
+  vector<uint16_t> keys_;         // exposition only
+  vector<container> containers_;  // exposition only
+
+  // Pairs up the chunks of a and b by key. Chunks held by both are combined by op, and those
+  // held by only one are kept when keep_a or keep_b says so.
+  template<class Op>
+  static constexpr roaring_bitmap
+  combine(const roaring_bitmap& a, const roaring_bitmap& b, Op op, bool keep_a,
+          bool keep_b) {  // exposition only
+    roaring_bitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    const auto keep = [&](const roaring_bitmap& from, size_t k) {
+      result.keys_.push_back(from.keys_[k]);
+      result.containers_.push_back(from.containers_[k]);
+    };
+    while (i != a.keys_.size() && j != b.keys_.size()) {
+      if (a.keys_[i] < b.keys_[j]) {
+        if (keep_a)
+          keep(a, i);
+        ++i;
+      } else if (b.keys_[j] < a.keys_[i]) {
+        if (keep_b)
+          keep(b, j);
+        ++j;
+      } else {
+        container chunk = op(a.containers_[i], b.containers_[j]);
+        if (!chunk.empty()) {
+          result.keys_.push_back(a.keys_[i]);
+          result.containers_.push_back(std::move(chunk));
+        }
+        ++i;
+        ++j;
+      }
+    }
+    for (; keep_a && i != a.keys_.size(); ++i)
+      keep(a, i);
+    for (; keep_b && j != b.keys_.size(); ++j)
+      keep(b, j);
+    return result;
+  }
+
+  class iterator {
+    friend roaring_bitmap;
+
+    const roaring_bitmap* parent_ = nullptr;
+    size_t chunk_ = 0;
+    size_t pos_ = 0;
+    uint32_t low_ = 0;
+
+    constexpr iterator(const roaring_bitmap* parent, size_t chunk)
+      : parent_(parent), chunk_(chunk) {
+      if (chunk_ != parent_->keys_.size())
+        low_ = parent_->containers_[chunk_].first(pos_);
+    }
+
+   public:
+    using iterator_concept = forward_iterator_tag;
+    using iterator_category = forward_iterator_tag;
+    using value_type = uint32_t;
+    using difference_type = ptrdiff_t;
+
+    iterator() = default;
+
+    constexpr uint32_t
+    operator*() const {
+      return uint32_t(parent_->keys_[chunk_]) << 16 | low_;
+    }
+
+    constexpr iterator&
+    operator++() {
+      low_ = parent_->containers_[chunk_].next(pos_, low_);
+      if (low_ == container::end_value) {
+        low_ = 0;
+        if (++chunk_ != parent_->keys_.size())
+          low_ = parent_->containers_[chunk_].first(pos_);
+      }
+      return *this;
+    }
+
+    constexpr iterator
+    operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y) {
+      return x.chunk_ == y.chunk_ && x.low_ == y.low_;
+    }
+  };
+
+ public:
+  roaring_bitmap() = default;
+
+  constexpr roaring_bitmap(initializer_list<uint32_t> values) {
+    for (uint32_t value : values)
+      insert(value);
+  }
+
+  template<input_range R>
+    requires convertible_to<range_reference_t<R>, uint32_t>
+  constexpr roaring_bitmap(from_range_t, R&& values) {
+    for (auto&& value : values)
+      insert(value);
+  }
+
+  constexpr void
+  insert(uint32_t value) {
+    const uint16_t key = value >> 16;
+    const auto it = ranges::lower_bound(keys_, key);
+    const auto i = it - keys_.begin();
+    if (it == keys_.end() || *it != key) {
+      keys_.insert(it, key);
+      containers_.emplace(containers_.begin() + i);
+    }
+    containers_[i].insert(uint16_t(value));
+  }
+
+  constexpr bool
+  contains(uint32_t value) const {
+    const auto it = ranges::lower_bound(keys_, uint16_t(value >> 16));
+    return it != keys_.end() && *it == value >> 16 &&
+      containers_[it - keys_.begin()].contains(uint16_t(value));
+  }
+
+  constexpr size_t
+  size() const {
+    size_t n = 0;
+    for (const container& chunk : containers_)
+      n += chunk.size();
+    return n;
+  }
+
+  constexpr bool
+  empty() const noexcept {
+    return keys_.empty();
+  }
+
+  // Stores each chunk as runs when that is smaller than its array or bitmap.
+  constexpr void
+  run_optimize() {
+    for (container& chunk : containers_)
+      chunk.run_optimize();
+  }
+
+  constexpr iterator
+  begin() const {
+    return iterator(this, 0);
+  }
+
+  constexpr iterator
+  end() const {
+    return iterator(this, keys_.size());
+  }
+
+  friend constexpr roaring_bitmap
+  operator&(const roaring_bitmap& a, const roaring_bitmap& b) {
+    return combine(a, b, bit_and<>{}, false, false);
+  }
+
+  friend constexpr roaring_bitmap
+  operator|(const roaring_bitmap& a, const roaring_bitmap& b) {
+    return combine(a, b, bit_or<>{}, true, true);
+  }
+
+  friend constexpr roaring_bitmap
+  operator-(const roaring_bitmap& a, const roaring_bitmap& b) {
+    return combine(a, b, minus<>{}, true, false);
+  }
+
+  friend constexpr roaring_bitmap
+  operator^(const roaring_bitmap& a, const roaring_bitmap& b) {
+    return combine(a, b, bit_xor<>{}, true, true);
+  }
+};
+
+namespace __detail {
+// The inputs the set views combine as roaring bitmaps rather than merge: bitmaps and views of
+// them.
+template<class R>
+concept __roaring_operand = same_as<remove_cvref_t<R>, roaring_bitmap> ||
+  same_as<remove_cvref_t<R>, ref_view<roaring_bitmap>> ||
+  same_as<remove_cvref_t<R>, ref_view<const roaring_bitmap>> ||
+  same_as<remove_cvref_t<R>, owning_view<roaring_bitmap>>;
+
+template<class R>
+constexpr const roaring_bitmap&
+__roaring_of(const R& r) {
+  if constexpr (same_as<R, roaring_bitmap>)
+    return r;
+  else
+    return r.base();
+}
+
+// The chunks of a bitmap, for the views that combine bitmaps chunk by chunk.
+struct __roaring_access {
+  static constexpr const vector<uint16_t>&
+  keys(const roaring_bitmap& b) noexcept {
+    return b.keys_;
+  }
+
+  static constexpr const vector<__roaring_container>&
+  containers(const roaring_bitmap& b) noexcept {
+    return b.containers_;
+  }
+};
+
+template<class Op>
+concept __roaring_op = same_as<Op, bit_and<>> || same_as<Op, bit_or<>> ||
+  same_as<Op, minus<>> || same_as<Op, bit_xor<>>;
+}  // namespace __detail
+
+// Op, one of bit_and, bit_or, minus and bit_xor, folded over roaring bitmaps as their operators
+// would fold it, but lazily: each step of the iterator pairs up the inputs' chunks for the next
+// key and combines only those. Nothing is computed before iteration and begin() is not cached, so
+// each iteration sees the bitmaps it refers to as they are when it starts.
+template<__detail::__roaring_op Op, view... Views>
+  requires(sizeof...(Views) > 0) && (__detail::__roaring_operand<Views> && ...)
+class roaring_combine_view : public view_interface<roaring_combine_view<Op, Views...>> {
+  using access = __detail::__roaring_access;        // exposition only
+  using container = __detail::__roaring_container;  // exposition only
+  static constexpr size_t K = sizeof...(Views);     // exposition only
+
+  tuple<Views...> views_;  // exposition only
+
+  class iterator {
+    friend roaring_combine_view;
+
+    array<const roaring_bitmap*, K> maps_{};  // exposition only
+    // The next chunk of each input not yet combined.
+    array<size_t, K> chunk_{};                // exposition only
+    uint32_t key_ = 0;                        // exposition only
+    container current_;                       // exposition only
+    size_t pos_ = 0;                          // exposition only
+    uint32_t low_ = container::end_value;     // exposition only
+
+    constexpr bool
+    live(size_t i) const {  // exposition only
+      return chunk_[i] != access::keys(*maps_[i]).size();
+    }
+
+    constexpr uint16_t
+    key_of(size_t i) const {  // exposition only
+      return access::keys(*maps_[i])[chunk_[i]];
+    }
+
+    // Combines the chunks of the least key left until one leaves a value, or the inputs run out.
+    // An intersection ends with its shortest input and a difference with its first.
+    constexpr void
+    next_chunk() {  // exposition only
+      while (true) {
+        size_t least = K;
+        for (size_t i = 0; i != K; ++i)
+          if (live(i) && (least == K || key_of(i) < key_of(least)))
+            least = i;
+        bool ended = least == K;
+        if constexpr (same_as<Op, bit_and<>>)
+          for (size_t i = 0; i != K; ++i)
+            ended = ended || !live(i);
+        else if constexpr (same_as<Op, minus<>>)
+          ended = ended || !live(0);
+        if (ended) {
+          low_ = container::end_value;
+          return;
+        }
+        const uint16_t key = key_of(least);
+        array<bool, K> holds{};
+        size_t holders = 0;
+        for (size_t i = 0; i != K; ++i)
+          holders += holds[i] = live(i) && key_of(i) == key;
+        bool kept = true;
+        if constexpr (same_as<Op, bit_and<>>)
+          kept = holders == K;
+        else if constexpr (same_as<Op, minus<>>)
+          kept = holds[0];
+        bool first = true;
+        for (size_t i = 0; i != K; ++i) {
+          if (!holds[i])
+            continue;
+          if (kept) {
+            const container& chunk = access::containers(*maps_[i])[chunk_[i]];
+            current_ = first ? chunk : Op{}(current_, chunk);
+            first = false;
+          }
+          ++chunk_[i];
+        }
+        if (kept && !current_.empty()) {
+          key_ = key;
+          low_ = current_.first(pos_);
+          return;
+        }
+      }
+    }
+
+    constexpr explicit iterator(array<const roaring_bitmap*, K> maps) : maps_(maps) {
+      next_chunk();
+    }
+
+   public:
+    using iterator_concept = forward_iterator_tag;
+    using iterator_category = forward_iterator_tag;
+    using value_type = uint32_t;
+    using difference_type = ptrdiff_t;
+
+    iterator() = default;
+
+    constexpr uint32_t
+    operator*() const {
+      return key_ << 16 | low_;
+    }
+
+    constexpr iterator&
+    operator++() {
+      low_ = current_.next(pos_, low_);
+      if (low_ == container::end_value)
+        next_chunk();
+      return *this;
+    }
+
+    constexpr iterator
+    operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y) {
+      return x.low_ == y.low_ && (x.low_ == container::end_value || x.chunk_ == y.chunk_);
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, default_sentinel_t) {
+      return x.low_ == container::end_value;
+    }
+  };
+
+ public:
+  roaring_combine_view()
+    requires(default_initializable<Views> && ...)
+  = default;
+
+  constexpr explicit roaring_combine_view(Op, Views... bases) : views_(std::move(bases)...) { }
+
+  constexpr iterator
+  begin() const {
+    return iterator(std::apply(
+      [](const Views&... views) {
+        return array<const roaring_bitmap*, K>{std::addressof(__detail::__roaring_of(views))...};
+      },
+      views_));
+  }
+
+  constexpr default_sentinel_t
+  end() const noexcept {
+    return default_sentinel;
+  }
+
+  // At most the smallest input for an intersection, the first for a difference and the sum of
+  // them otherwise.
+  constexpr size_t
+  reserve_hint() const {
+    return std::apply(
+      [](const Views&... views) {
+        const size_t sizes[] = {__detail::__roaring_of(views).size()...};
+        if constexpr (same_as<Op, bit_and<>>)
+          return ranges::min(sizes);
+        else if constexpr (same_as<Op, minus<>>)
+          return sizes[0];
+        else
+          return (size_t(0) + ... + __detail::__roaring_of(views).size());
+      },
+      views_);
+  }
+};
+
+template<class Op, class... Rs>
+roaring_combine_view(Op, Rs&&...) -> roaring_combine_view<Op, views::all_t<Rs>...>;
+
+template<class Op, class... Views>
+constexpr bool enable_borrowed_range<roaring_combine_view<Op, Views...>> =
+  (enable_borrowed_range<Views> && ...);
+
+}  // namespace std::ranges
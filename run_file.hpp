@@ -0,0 +1,318 @@
+#pragma once
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace std::ranges {
+namespace __detail {
+// Closes the descriptor it holds, so that a constructor throwing after open() does not leak it.
+class __file_descriptor {
+  int fd_ = -1;
+
+ public:
+  explicit __file_descriptor(int fd) noexcept : fd_(fd) { }
+
+  __file_descriptor(const __file_descriptor&) = delete;
+  __file_descriptor& operator=(const __file_descriptor&) = delete;
+
+  ~__file_descriptor() {
+    if (fd_ != -1)
+      ::close(fd_);
+  }
+
+  int
+  get() const noexcept {
+    return fd_;
+  }
+};
+
+// The one background thread that refills the buffers of every open run file, so that merging
+// hundreds of runs does not start hundreds of threads. Refills are served in the order they are
+// asked for, which keeps those of each file in file order. Every reader holds a reference, so the
+// thread outlives the last reader even when that reader is destroyed after static destructors run.
+class __run_file_io {
+  struct job {
+    void (*run)(void*, size_t);
+    void* owner;
+    size_t index;
+  };
+
+  mutex mutex_;
+  condition_variable_any pending_;
+  condition_variable_any idle_;
+  deque<job> jobs_;
+  void* running_ = nullptr;  // the owner of the refill in progress
+  jthread thread_;
+
+  void
+  serve(stop_token stop) {
+    while (true) {
+      job j;
+      {
+        unique_lock lock(mutex_);
+        if (!pending_.wait(lock, stop, [&] { return !jobs_.empty(); }))
+          return;
+        j = jobs_.front();
+        jobs_.pop_front();
+        running_ = j.owner;
+      }
+      j.run(j.owner, j.index);
+      {
+        lock_guard lock(mutex_);
+        running_ = nullptr;
+      }
+      idle_.notify_all();
+    }
+  }
+
+  __run_file_io() : thread_([this](stop_token stop) { serve(std::move(stop)); }) { }
+
+ public:
+  static shared_ptr<__run_file_io>
+  instance() {
+    static const shared_ptr<__run_file_io> io(new __run_file_io);
+    return io;
+  }
+
+  // Queues run(owner, index) behind the refills already asked for.
+  void
+  submit(void (*run)(void*, size_t), void* owner, size_t index) {
+    {
+      lock_guard lock(mutex_);
+      jobs_.push_back({run, owner, index});
+    }
+    pending_.notify_one();
+  }
+
+  // Drops the refills queued for owner and waits out one in progress, after which owner may go.
+  void
+  cancel(void* owner) {
+    unique_lock lock(mutex_);
+    erase_if(jobs_, [&](const job& j) { return j.owner == owner; });
+    idle_.wait(lock, [&] { return running_ != owner; });
+  }
+};
+
+// Reads a file of records of T through two buffers. The shared __run_file_io thread fills
+// whichever buffer the consumer has handed back while the consumer reads the other, so the
+// consumer waits on the disk only when it has drained one buffer before the other has been
+// filled. A ready buffer holding no records marks the end of the file, or carries the read error
+// that ended it, rethrown only once the consumer reaches that buffer.
+template<class T>
+class __run_file_reader {
+  struct buffer {
+    unique_ptr<T[]> records;
+    size_t count = 0;
+    bool ready = false;
+    exception_ptr error;
+  };
+
+  shared_ptr<__run_file_io> io_ = __run_file_io::instance();
+  __file_descriptor fd_;
+  size_t capacity_ = 0;
+  array<buffer, 2> buffers_;
+  size_t front_ = 0;  // the buffer the consumer reads
+  size_t pos_ = 0;    // the consumer's record in it
+  off_t offset_ = 0;  // where the next refill reads from; touched only by the I/O thread
+  bool eof_ = false;  // likewise
+  mutex mutex_;
+  condition_variable ready_;
+
+  // Reads up to capacity_ records from offset into records and returns how many it read.
+  size_t
+  read(T* records, off_t offset) {
+    byte* out = reinterpret_cast<byte*>(records);
+    const size_t want = capacity_ * sizeof(T);
+    size_t got = 0;
+    while (got != want) {
+      const ssize_t n = ::pread(fd_.get(), out + got, want - got, offset + off_t(got));
+      if (n == 0)
+        break;
+      if (n == -1) {
+        if (errno == EINTR)
+          continue;
+        throw system_error(errno, system_category(), "pread");
+      }
+      got += size_t(n);
+    }
+    return got / sizeof(T);
+  }
+
+  // Refills buffer index on the I/O thread. Once the file has run out, or a read has failed, every
+  // refill comes back empty.
+  void
+  fill(size_t index) {
+    buffer& b = buffers_[index];
+    size_t count = 0;
+    exception_ptr error;
+    if (!eof_) {
+      try {
+        count = read(b.records.get(), offset_);
+      } catch (...) {
+        error = current_exception();
+      }
+      offset_ += off_t(count * sizeof(T));
+      eof_ = count < capacity_;
+    }
+    {
+      lock_guard lock(mutex_);
+      b.count = count;
+      b.ready = true;
+      b.error = std::move(error);
+    }
+    ready_.notify_all();
+  }
+
+  static void
+  fill_job(void* self, size_t index) {
+    static_cast<__run_file_reader*>(self)->fill(index);
+  }
+
+  void
+  wait_front() {
+    unique_lock lock(mutex_);
+    ready_.wait(lock, [&] { return buffers_[front_].ready; });
+    if (buffers_[front_].error)
+      rethrow_exception(buffers_[front_].error);
+  }
+
+ public:
+  __run_file_reader(const filesystem::path& path, size_t capacity)
+    : fd_(::open(path.c_str(), O_RDONLY | O_CLOEXEC)), capacity_(capacity == 0 ? 1 : capacity) {
+    if (fd_.get() == -1)
+      throw system_error(errno, system_category(), "open");
+    ::posix_fadvise(fd_.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    for (buffer& b : buffers_)
+      b.records = make_unique_for_overwrite<T[]>(capacity_);
+    try {
+      io_->submit(&fill_job, this, 0);
+      io_->submit(&fill_job, this, 1);
+      wait_front();
+    } catch (...) {
+      io_->cancel(this);
+      throw;
+    }
+  }
+
+  __run_file_reader(const __run_file_reader&) = delete;
+  __run_file_reader& operator=(const __run_file_reader&) = delete;
+
+  ~__run_file_reader() {
+    io_->cancel(this);
+  }
+
+  bool
+  at_end() const noexcept {
+    return buffers_[front_].count == 0;
+  }
+
+  const T&
+  current() const noexcept {
+    return buffers_[front_].records[pos_];
+  }
+
+  // Steps to the next record. Past the last record of the front buffer, hands that buffer back to
+  // be refilled and continues in the other one, waiting only if it is not yet ready.
+  void
+  next() {
+    if (++pos_ != buffers_[front_].count)
+      return;
+    {
+      lock_guard lock(mutex_);
+      buffers_[front_].ready = false;
+    }
+    io_->submit(&fill_job, this, front_);
+    front_ ^= 1;
+    pos_ = 0;
+    wait_front();
+  }
+};
+}  // namespace __detail
+
+// The records of a file of fixed-width, trivially copyable T, such as one sorted run of an
+// external merge, streamed through two buffers of buffer_records records each. One background
+// thread, shared by every run_file_view, refills them with pread. Memory stays bounded by the two
+// buffers however long the file is, so set_union_view and set_difference_view can merge many runs
+// larger than memory. Like istream_view it is a single-pass input view; the reference an iterator
+// yields lasts until it is next incremented.
+template<class T>
+  requires is_object_v<T> && is_trivially_copyable_v<T>
+class run_file_view : public view_interface<run_file_view<T>> {
+  unique_ptr<__detail::__run_file_reader<T>> reader_;  // exposition only
+
+  class iterator {
+    friend run_file_view;
+
+    __detail::__run_file_reader<T>* reader_ = nullptr;
+
+    constexpr explicit iterator(__detail::__run_file_reader<T>* reader) : reader_(reader) { }
+
+   public:
+    using iterator_concept = input_iterator_tag;
+    using value_type = remove_cv_t<T>;
+    using difference_type = ptrdiff_t;
+
+    iterator() = default;
+    iterator(const iterator&) = delete;
+    iterator(iterator&&) = default;
+    iterator& operator=(const iterator&) = delete;
+    iterator& operator=(iterator&&) = default;
+
+    const T&
+    operator*() const noexcept {
+      return reader_->current();
+    }
+
+    iterator&
+    operator++() {
+      reader_->next();
+      return *this;
+    }
+
+    void
+    operator++(int) {
+      ++*this;
+    }
+
+    friend bool
+    operator==(const iterator& x, default_sentinel_t) noexcept {
+      return x.reader_ == nullptr || x.reader_->at_end();
+    }
+  };
+
+ public:
+  static constexpr size_t default_buffer_records = size_t(1) << 16;
+
+  run_file_view() = default;
+
+  explicit run_file_view(const filesystem::path& path,
+                         size_t buffer_records = default_buffer_records)
+    : reader_(make_unique<__detail::__run_file_reader<T>>(path, buffer_records)) { }
+
+  iterator
+  begin() {
+    return iterator(reader_.get());
+  }
+
+  constexpr default_sentinel_t
+  end() const noexcept {
+    return default_sentinel;
+  }
+};
+}  // namespace std::ranges
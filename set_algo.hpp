@@ -1,4 +1,10 @@
+#include <optional>
 #include <ranges>
+#include <utility>
+
+#include "concepts.h"
+#include "roaring.hpp"
+#include "set_kernels.h"
 
 namespace std::ranges::__detail {
 template<class R1, class R2>
@@ -7,6 +13,43 @@ concept __set_associable = input_range<R1> && input_range<R2> &&
 
 template<class R1, class R2>
 concept __set_associable_concatable = __set_associable<R1, R2> && __concatable<R1, R2>;
+
+// Pairs of views whose set iterators can also step backwards. Past-the-end has to be an iterator
+// to step back from, so both views must be common.
+template<class R1, class R2>
+concept __set_reversible = bidirectional_range<R1> && bidirectional_range<R2> &&
+  common_range<R1> && common_range<R2>;
+
+// Moves pos back over the elements equivalent to key just before it, which must all be ordered
+// no later than key, and returns how many it passed.
+template<class I, class T>
+constexpr iter_difference_t<I>
+__retreat_run(const I& first, I& pos, const T& key) {
+  iter_difference_t<I> n = 0;
+  while (pos != first) {
+    I prev = ranges::prev(pos);
+    if (*prev < key)
+      break;
+    pos = std::move(prev);
+    ++n;
+  }
+  return n;
+}
+
+// The greater of the elements just before pos1 and pos2, at least one of which has one.
+template<class I1, class I2>
+constexpr common_reference_t<iter_reference_t<I1>, iter_reference_t<I2>>
+__last_before(const I1& first1, const I1& pos1, const I2& first2, const I2& pos2) {
+  if (pos1 == first1)
+    return *ranges::prev(pos2);
+  if (pos2 == first2)
+    return *ranges::prev(pos1);
+  iter_reference_t<I1> x = *ranges::prev(pos1);
+  iter_reference_t<I2> y = *ranges::prev(pos2);
+  if (x < y)
+    return std::forward<iter_reference_t<I2>>(y);
+  return std::forward<iter_reference_t<I1>>(x);
+}
 }  // namespace std::ranges::__detail
 
 namespace std::ranges {
@@ -26,17 +69,26 @@ class set_difference_view {
     sentinel_t<Base1> end1_ = sentinel_t<Base1>();
     iterator_t<Base2> current2_ = iterator_t<Base2>();
     sentinel_t<Base2> end2_ = sentinel_t<Base2>();
+    // Reversible iterators also hold where the inputs start, so stepping back stops there.
+    static constexpr bool reversible = __detail::__set_reversible<Base1, Base2>;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base1>> begin1_;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base2>> begin2_;
 
     constexpr void
     satisfy() {
+      ranges::less less;
+      identity proj;
       while (current1_ != end1_) {
         if (current2_ == end2_)
           return;
         if (*current1_ < *current2_)
           return;
-        if (!(*current2_ < *current1_))
+        if (*current2_ < *current1_)
+          __detail::__seek_to(less, proj, current2_, end2_, *current1_);
+        else {
           ++current1_;
-        ++current2_;
+          ++current2_;
+        }
       }
     }
 
@@ -49,11 +101,21 @@ class set_difference_view {
       satisfy();
     }
 
+    constexpr explicit iterator(iterator_t<Base1> first1, iterator_t<Base1> current1,
+                                sentinel_t<Base1> end1, iterator_t<Base2> first2,
+                                iterator_t<Base2> current2, sentinel_t<Base2> end2)
+      requires reversible
+      : iterator(std::move(current1), std::move(end1), std::move(current2), std::move(end2)) {
+      begin1_ = std::move(first1);
+      begin2_ = std::move(first2);
+    }
+
    public:
     using value_type = range_value_t<Base1>;
     using difference_type = range_difference_t<Base1>;
     using iterator_concept =
-      conditional_t<forward_range<Base1>, forward_iterator_tag, input_iterator_tag>;
+      conditional_t<reversible, bidirectional_iterator_tag,
+                    conditional_t<forward_range<Base1>, forward_iterator_tag, input_iterator_tag>>;
 
     iterator()
       requires default_initializable<iterator_t<Base1>> && default_initializable<iterator_t<Base2>>
@@ -67,7 +129,12 @@ class set_difference_view {
       : current1_(std::move(i.current1_)),
         end1_(std::move(i.end1)),
         current2_(std::move(i.current2_)),
-        end2_(std::move(i.end2)) { }
+        end2_(std::move(i.end2)) {
+      if constexpr (reversible && iterator<!Const>::reversible) {
+        begin1_ = std::move(i.begin1_);
+        begin2_ = std::move(i.begin2_);
+      }
+    }
 
     constexpr decltype(auto)
     operator*() const {
@@ -95,6 +162,61 @@ class set_difference_view {
       return tmp;
     }
 
+    // Steps back to the last element of the first input before current1_ that is ranked past the
+    // equivalent elements of the second input, leaving current2_ past those.
+    constexpr iterator&
+    operator--()
+      requires reversible
+    {
+      if (current1_ == end1_)
+        current2_ = end2_;
+      while (true) {
+        auto prev1 = ranges::prev(current1_);
+        auto&& x = *prev1;
+        while (current2_ != begin2_) {
+          auto prev2 = ranges::prev(current2_);
+          if (!(x < *prev2))
+            break;
+          current2_ = std::move(prev2);
+        }
+        auto start1 = prev1;
+        const auto rank = __detail::__retreat_run(begin1_, start1, x);
+        auto start2 = current2_;
+        const auto matched = __detail::__retreat_run(begin2_, start2, x);
+        if (rank >= matched) {
+          current1_ = std::move(prev1);
+          return *this;
+        }
+        current1_ = std::move(start1);
+        current2_ = std::move(start2);
+      }
+    }
+
+    constexpr iterator
+    operator--(int)
+      requires reversible
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    // Moves to the first element not less than target, skipping ahead in both inputs rather than
+    // stepping through the elements in between.
+    template<class Key>
+      requires totally_ordered_with<range_reference_t<Base1>, const Key&> &&
+               totally_ordered_with<range_reference_t<Base2>, const Key&>
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel || !(*current1_ < target))
+        return;
+      ranges::less less;
+      identity proj;
+      __detail::__seek_to(less, proj, current1_, end1_, target);
+      __detail::__seek_to(less, proj, current2_, end2_, target);
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
       requires equality_comparable<iterator_t<Base1>>
@@ -113,6 +235,22 @@ class set_difference_view {
     }
   };
 
+  // An iterator at the start or, for reversible views, at the end of self.
+  template<bool Const>
+  static constexpr iterator<Const>
+  make_iterator(__detail::__maybe_const_t<Const, set_difference_view>& self, bool at_end) {
+    if constexpr (iterator<Const>::reversible) {
+      auto first1 = ranges::begin(self.base1_);
+      auto first2 = ranges::begin(self.base2_);
+      auto last1 = ranges::end(self.base1_);
+      auto last2 = ranges::end(self.base2_);
+      return iterator<Const>(first1, at_end ? last1 : first1, last1, first2,
+                             at_end ? last2 : first2, last2);
+    } else
+      return iterator<Const>(ranges::begin(self.base1_), ranges::end(self.base1_),
+                             ranges::begin(self.base2_), ranges::end(self.base2_));
+  }
+
  public:
   set_difference_view()
     requires default_initializable<V1> && default_initializable<V2>
@@ -125,21 +263,49 @@ class set_difference_view {
   begin()
     requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
   {
-    return iterator<false>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                           ranges::end(base2_));
+    return make_iterator<false>(*this, false);
   }
 
   constexpr auto
   begin() const
     requires __detail::__set_associable<const V1, const V2>
   {
-    return iterator<true>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                          ranges::end(base2_));
+    return make_iterator<true>(*this, false);
+  }
+
+  constexpr auto
+  end()
+    requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
+  {
+    if constexpr (__detail::__set_reversible<V1, V2>)
+      return make_iterator<false>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  constexpr auto
+  end() const
+    requires __detail::__set_associable<const V1, const V2>
+  {
+    if constexpr (__detail::__set_reversible<const V1, const V2>)
+      return make_iterator<true>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  // No more elements than the first input.
+  constexpr auto
+  reserve_hint()
+    requires approximately_sized_range<V1>
+  {
+    return ranges::reserve_hint(base1_);
   }
 
-  constexpr default_sentinel_t
-  end() const noexcept {
-    return default_sentinel;
+  constexpr auto
+  reserve_hint() const
+    requires approximately_sized_range<const V1>
+  {
+    return ranges::reserve_hint(base1_);
   }
 };
 
@@ -158,7 +324,11 @@ struct _SetDifference : __adaptor::_RangeAdaptor<_SetDifference> {
     }
   constexpr auto
   operator()(R1&& r1, R2&& r2) const {
-    return set_difference_view(std::forward<R1>(r1), std::forward<R2>(r2));
+    if constexpr (ranges::__detail::__roaring_operand<R1> &&
+                  ranges::__detail::__roaring_operand<R2>)
+      return roaring_combine_view(minus<>{}, std::forward<R1>(r1), std::forward<R2>(r2));
+    else
+      return set_difference_view(std::forward<R1>(r1), std::forward<R2>(r2));
   }
 
   using _RangeAdaptor<_SetDifference>::operator();
@@ -188,18 +358,40 @@ class set_intersection_view {
     sentinel_t<Base1> end1_ = sentinel_t<Base1>();
     iterator_t<Base2> current2_ = iterator_t<Base2>();
     sentinel_t<Base2> end2_ = sentinel_t<Base2>();
+    // Reversible iterators also hold where the inputs start, so stepping back stops there.
+    static constexpr bool reversible = __detail::__set_reversible<Base1, Base2>;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base1>> begin1_;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base2>> begin2_;
+
+    // Contiguous word-sized inputs are merged a block at a time by a vector kernel that fills
+    // buffer_, and the iterator hands the buffered matches out one by one.
+    static constexpr bool use_kernel = __detail::__simd_set_operable<Base1, Base2>;
+    [[no_unique_address]] __detail::__maybe_present_t<
+      use_kernel, __detail::__set_block_buffer<range_value_t<Base1>>> buffer_;
 
     constexpr void
     satisfy() {
+      if constexpr (use_kernel) {
+        buffer_.template satisfy<__detail::__set_kernel_op::intersection>(current1_, end1_,
+                                                                          current2_, end2_);
+        return;
+      }
+      ranges::less less;
+      identity proj;
       while (current1_ != end1_ && current2_ != end2_) {
         if (*current1_ < *current2_)
-          ++current1_;
+          __detail::__seek_to(less, proj, current1_, end1_, *current2_);
         else {
           if (!(*current2_ < *current1_))
             return;
-          ++current2_;
+          __detail::__seek_to(less, proj, current2_, end2_, *current1_);
         }
       }
+      // Once either input runs out, both sit at their ends, where a reversible end() points.
+      if constexpr (reversible) {
+        current1_ = end1_;
+        current2_ = end2_;
+      }
     }
 
     constexpr explicit iterator(iterator_t<Base1> current1, sentinel_t<Base1> end1,
@@ -208,14 +400,26 @@ class set_intersection_view {
         end1_(std::move(end1)),
         current2_(std::move(current2)),
         end2_(std::move(end2)) {
+      if constexpr (use_kernel)
+        buffer_.start(current1_);
       satisfy();
     }
 
+    constexpr explicit iterator(iterator_t<Base1> first1, iterator_t<Base1> current1,
+                                sentinel_t<Base1> end1, iterator_t<Base2> first2,
+                                iterator_t<Base2> current2, sentinel_t<Base2> end2)
+      requires reversible
+      : iterator(std::move(current1), std::move(end1), std::move(current2), std::move(end2)) {
+      begin1_ = std::move(first1);
+      begin2_ = std::move(first2);
+    }
+
    public:
     using value_type = range_value_t<Base1>;
     using difference_type = range_difference_t<Base1>;
     using iterator_concept =
-      conditional_t<forward_range<Base1>, forward_iterator_tag, input_iterator_tag>;
+      conditional_t<reversible, bidirectional_iterator_tag,
+                    conditional_t<forward_range<Base1>, forward_iterator_tag, input_iterator_tag>>;
 
     iterator()
       requires default_initializable<iterator_t<Base1>> && default_initializable<iterator_t<Base2>>
@@ -229,7 +433,18 @@ class set_intersection_view {
       : current1_(std::move(i.current1_)),
         end1_(std::move(i.end1)),
         current2_(std::move(i.current2_)),
-        end2_(std::move(i.end2)) { }
+        end2_(std::move(i.end2)) {
+      if constexpr (reversible && iterator<!Const>::reversible) {
+        begin1_ = std::move(i.begin1_);
+        begin2_ = std::move(i.begin2_);
+      }
+      if constexpr (use_kernel && iterator<!Const>::use_kernel)
+        buffer_ = i.buffer_;
+      else if constexpr (use_kernel) {
+        buffer_.start(current1_);
+        satisfy();
+      }
+    }
 
     constexpr decltype(auto)
     operator*() const {
@@ -238,8 +453,12 @@ class set_intersection_view {
 
     constexpr iterator&
     operator++() {
-      ++current1_;
-      ++current2_;
+      if constexpr (use_kernel)
+        buffer_.pop();
+      else {
+        ++current1_;
+        ++current2_;
+      }
       satisfy();
       return *this;
     }
@@ -258,6 +477,90 @@ class set_intersection_view {
       return tmp;
     }
 
+    // Steps back to the previous pair of equivalent elements. Within a run of equivalent elements
+    // that is the pair before; otherwise both cursors retreat to the last key the inputs share
+    // and land on its last pair, which pairs elements of equal rank.
+    constexpr iterator&
+    operator--()
+      requires reversible
+    {
+      if constexpr (use_kernel) {
+        // The kernel leaves current2_ wherever its block loop stopped, which can be short of the
+        // partner of current1_ as well as past it, so the partner is found afresh: the element of
+        // the same rank among those equivalent to *current1_ in the second input.
+        if (current1_ == end1_)
+          current2_ = end2_;
+        else {
+          auto&& x = *current1_;
+          auto start1 = current1_;
+          const auto rank = __detail::__retreat_run(begin1_, start1, x);
+          ranges::less less;
+          identity proj;
+          current2_ = begin2_;
+          __detail::__seek_to(less, proj, current2_, end2_, x);
+          ranges::advance(current2_, rank);
+        }
+      }
+      if (current1_ != end1_ && current1_ != begin1_ &&
+          !(*ranges::prev(current1_) < *current1_)) {
+        --current1_;
+        --current2_;
+      } else {
+        while (true) {
+          auto prev1 = ranges::prev(current1_);
+          auto prev2 = ranges::prev(current2_);
+          if (*prev1 < *prev2)
+            current2_ = std::move(prev2);
+          else if (*prev2 < *prev1)
+            current1_ = std::move(prev1);
+          else
+            break;
+        }
+        auto&& x = *ranges::prev(current1_);
+        const difference_type count1 = __detail::__retreat_run(begin1_, current1_, x);
+        const difference_type count2 = __detail::__retreat_run(begin2_, current2_, x);
+        const difference_type last = ranges::min(count1, count2) - 1;
+        ranges::advance(current1_, range_difference_t<Base1>(last));
+        ranges::advance(current2_, range_difference_t<Base2>(last));
+      }
+      if constexpr (use_kernel) {
+        buffer_.hold(current1_);
+        ++current2_;
+      }
+      return *this;
+    }
+
+    constexpr iterator
+    operator--(int)
+      requires reversible
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    // Moves to the first element not less than target, skipping ahead in both inputs rather than
+    // stepping through the elements in between.
+    template<class Key>
+      requires totally_ordered_with<range_reference_t<Base1>, const Key&> &&
+               totally_ordered_with<range_reference_t<Base2>, const Key&>
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel || !(*current1_ < target))
+        return;
+      if constexpr (use_kernel) {
+        if (buffer_.skip(current1_, target))
+          return;
+      }
+      ranges::less less;
+      identity proj;
+      __detail::__seek_to(less, proj, current1_, end1_, target);
+      __detail::__seek_to(less, proj, current2_, end2_, target);
+      if constexpr (use_kernel)
+        buffer_.start(current1_);
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
       requires equality_comparable<iterator_t<Base1>>
@@ -267,6 +570,8 @@ class set_intersection_view {
 
     friend constexpr bool
     operator==(const iterator& x, default_sentinel_t) {
+      if constexpr (use_kernel)
+        return x.current1_ == x.end1_;
       return x.current1_ == x.end1_ || x.current2_ == x.end2_;
     }
 
@@ -276,6 +581,22 @@ class set_intersection_view {
     }
   };
 
+  // An iterator at the start or, for reversible views, at the end of self.
+  template<bool Const>
+  static constexpr iterator<Const>
+  make_iterator(__detail::__maybe_const_t<Const, set_intersection_view>& self, bool at_end) {
+    if constexpr (iterator<Const>::reversible) {
+      auto first1 = ranges::begin(self.base1_);
+      auto first2 = ranges::begin(self.base2_);
+      auto last1 = ranges::end(self.base1_);
+      auto last2 = ranges::end(self.base2_);
+      return iterator<Const>(first1, at_end ? last1 : first1, last1, first2,
+                             at_end ? last2 : first2, last2);
+    } else
+      return iterator<Const>(ranges::begin(self.base1_), ranges::end(self.base1_),
+                             ranges::begin(self.base2_), ranges::end(self.base2_));
+  }
+
  public:
   set_intersection_view()
     requires default_initializable<V1> && default_initializable<V2>
@@ -288,21 +609,55 @@ class set_intersection_view {
   begin()
     requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
   {
-    return iterator<false>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                           ranges::end(base2_));
+    return make_iterator<false>(*this, false);
   }
 
   constexpr auto
   begin() const
     requires __detail::__set_associable<const V1, const V2>
   {
-    return iterator<true>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                          ranges::end(base2_));
+    return make_iterator<true>(*this, false);
+  }
+
+  constexpr auto
+  end()
+    requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
+  {
+    if constexpr (__detail::__set_reversible<V1, V2>)
+      return make_iterator<false>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  constexpr auto
+  end() const
+    requires __detail::__set_associable<const V1, const V2>
+  {
+    if constexpr (__detail::__set_reversible<const V1, const V2>)
+      return make_iterator<true>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  // No more elements than the shorter input.
+  constexpr auto
+  reserve_hint()
+    requires approximately_sized_range<V1> && approximately_sized_range<V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    return ranges::min(CT(hint1), CT(hint2));
   }
 
-  constexpr default_sentinel_t
-  end() const noexcept {
-    return default_sentinel;
+  constexpr auto
+  reserve_hint() const
+    requires approximately_sized_range<const V1> && approximately_sized_range<const V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    return ranges::min(CT(hint1), CT(hint2));
   }
 };
 
@@ -321,7 +676,11 @@ struct _SetIntersection : __adaptor::_RangeAdaptor<_SetIntersection> {
     }
   constexpr auto
   operator()(R1&& r1, R2&& r2) const {
-    return set_intersection_view(std::forward<R1>(r1), std::forward<R2>(r2));
+    if constexpr (ranges::__detail::__roaring_operand<R1> &&
+                  ranges::__detail::__roaring_operand<R2>)
+      return roaring_combine_view(bit_and<>{}, std::forward<R1>(r1), std::forward<R2>(r2));
+    else
+      return set_intersection_view(std::forward<R1>(r1), std::forward<R2>(r2));
   }
 
   using _RangeAdaptor<_SetIntersection>::operator();
@@ -352,6 +711,10 @@ class set_union_view {
     sentinel_t<Base1> end1_ = sentinel_t<Base1>();
     iterator_t<Base2> current2_ = iterator_t<Base2>();
     sentinel_t<Base2> end2_ = sentinel_t<Base2>();
+    // Reversible iterators also hold where the inputs start, so stepping back stops there.
+    static constexpr bool reversible = __detail::__set_reversible<Base1, Base2>;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base1>> begin1_;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base2>> begin2_;
     set_state state_ = set_state::first;
 
     constexpr void
@@ -382,11 +745,22 @@ class set_union_view {
       satisfy();
     }
 
+    constexpr explicit iterator(iterator_t<Base1> first1, iterator_t<Base1> current1,
+                                sentinel_t<Base1> end1, iterator_t<Base2> first2,
+                                iterator_t<Base2> current2, sentinel_t<Base2> end2)
+      requires reversible
+      : iterator(std::move(current1), std::move(end1), std::move(current2), std::move(end2)) {
+      begin1_ = std::move(first1);
+      begin2_ = std::move(first2);
+    }
+
    public:
     using value_type = __detail::__concat_value_t<Base1, Base2>;
     using difference_type = common_type_t<range_difference_t<Base1>, range_difference_t<Base2>>;
-    using iterator_concept = conditional_t<forward_range<Base1> && forward_range<Base2>,
-                                           forward_iterator_tag, input_iterator_tag>;
+    using iterator_concept =
+      conditional_t<reversible, bidirectional_iterator_tag,
+                    conditional_t<forward_range<Base1> && forward_range<Base2>,
+                                  forward_iterator_tag, input_iterator_tag>>;
 
     iterator()
       requires default_initializable<iterator_t<Base1>> && default_initializable<iterator_t<Base2>>
@@ -401,7 +775,12 @@ class set_union_view {
         end1_(std::move(i.end1)),
         current2_(std::move(i.current2_)),
         end2_(std::move(i.end2)),
-        state_(i.state_) { }
+        state_(i.state_) {
+      if constexpr (reversible && iterator<!Const>::reversible) {
+        begin1_ = std::move(i.begin1_);
+        begin2_ = std::move(i.begin2_);
+      }
+    }
 
     constexpr __detail::__concat_reference_t<Base1, Base2>
     operator*() const {
@@ -434,6 +813,68 @@ class set_union_view {
       return tmp;
     }
 
+    // Steps back through the greatest key before the cursors. Equivalent elements are taken from
+    // the first input, each one consuming its partner of equal rank from the second, and only the
+    // second input's surplus elements come from it.
+    constexpr iterator&
+    operator--()
+      requires reversible
+    {
+      while (true) {
+        auto&& x = __detail::__last_before(begin1_, current1_, begin2_, current2_);
+        auto start1 = current1_;
+        const auto count1 = __detail::__retreat_run(begin1_, start1, x);
+        auto start2 = current2_;
+        const auto count2 = __detail::__retreat_run(begin2_, start2, x);
+        if (current1_ != end1_ && !(x < *current1_)) {
+          // Within the first input's run of x: its earlier element had a partner if the second
+          // input has more of them before current2_.
+          if (count1 > 0) {
+            --current1_;
+            if (count2 > count1)
+              --current2_;
+            state_ = set_state::first;
+            return *this;
+          }
+          current2_ = std::move(start2);
+          continue;
+        }
+        if (count2 > count1) {
+          --current2_;
+          state_ = set_state::second;
+        } else {
+          --current1_;
+          state_ = set_state::first;
+        }
+        return *this;
+      }
+    }
+
+    constexpr iterator
+    operator--(int)
+      requires reversible
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    // Moves to the first element not less than target, skipping ahead in both inputs rather than
+    // stepping through the elements in between.
+    template<class Key>
+      requires totally_ordered_with<range_reference_t<Base1>, const Key&> &&
+               totally_ordered_with<range_reference_t<Base2>, const Key&>
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel || !(**this < target))
+        return;
+      ranges::less less;
+      identity proj;
+      __detail::__seek_to(less, proj, current1_, end1_, target);
+      __detail::__seek_to(less, proj, current2_, end2_, target);
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
       requires equality_comparable<iterator_t<Base1>> && equality_comparable<iterator_t<Base2>>
@@ -454,6 +895,22 @@ class set_union_view {
     }
   };
 
+  // An iterator at the start or, for reversible views, at the end of self.
+  template<bool Const>
+  static constexpr iterator<Const>
+  make_iterator(__detail::__maybe_const_t<Const, set_union_view>& self, bool at_end) {
+    if constexpr (iterator<Const>::reversible) {
+      auto first1 = ranges::begin(self.base1_);
+      auto first2 = ranges::begin(self.base2_);
+      auto last1 = ranges::end(self.base1_);
+      auto last2 = ranges::end(self.base2_);
+      return iterator<Const>(first1, at_end ? last1 : first1, last1, first2,
+                             at_end ? last2 : first2, last2);
+    } else
+      return iterator<Const>(ranges::begin(self.base1_), ranges::end(self.base1_),
+                             ranges::begin(self.base2_), ranges::end(self.base2_));
+  }
+
  public:
   set_union_view()
     requires default_initializable<V1> && default_initializable<V2>
@@ -466,21 +923,55 @@ class set_union_view {
   begin()
     requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
   {
-    return iterator<false>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                           ranges::end(base2_));
+    return make_iterator<false>(*this, false);
   }
 
   constexpr auto
   begin() const
     requires __detail::__set_associable_concatable<const V1, const V2>
   {
-    return iterator<true>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                          ranges::end(base2_));
+    return make_iterator<true>(*this, false);
+  }
+
+  constexpr auto
+  end()
+    requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
+  {
+    if constexpr (__detail::__set_reversible<V1, V2>)
+      return make_iterator<false>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  constexpr auto
+  end() const
+    requires __detail::__set_associable_concatable<const V1, const V2>
+  {
+    if constexpr (__detail::__set_reversible<const V1, const V2>)
+      return make_iterator<true>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  // No more elements than both inputs together.
+  constexpr auto
+  reserve_hint()
+    requires approximately_sized_range<V1> && approximately_sized_range<V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    return CT(hint1) + CT(hint2);
   }
 
-  constexpr default_sentinel_t
-  end() const noexcept {
-    return default_sentinel;
+  constexpr auto
+  reserve_hint() const
+    requires approximately_sized_range<const V1> && approximately_sized_range<const V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    return CT(hint1) + CT(hint2);
   }
 };
 
@@ -499,7 +990,11 @@ struct _SetUnion : __adaptor::_RangeAdaptor<_SetUnion> {
     }
   constexpr auto
   operator()(R1&& r1, R2&& r2) const {
-    return set_union_view(std::forward<R1>(r1), std::forward<R2>(r2));
+    if constexpr (ranges::__detail::__roaring_operand<R1> &&
+                  ranges::__detail::__roaring_operand<R2>)
+      return roaring_combine_view(bit_or<>{}, std::forward<R1>(r1), std::forward<R2>(r2));
+    else
+      return set_union_view(std::forward<R1>(r1), std::forward<R2>(r2));
   }
 
   using _RangeAdaptor<_SetUnion>::operator();
@@ -530,6 +1025,10 @@ class set_symmetric_difference_view {
     sentinel_t<Base1> end1_ = sentinel_t<Base1>();
     iterator_t<Base2> current2_ = iterator_t<Base2>();
     sentinel_t<Base2> end2_ = sentinel_t<Base2>();
+    // Reversible iterators also hold where the inputs start, so stepping back stops there.
+    static constexpr bool reversible = __detail::__set_reversible<Base1, Base2>;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base1>> begin1_;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base2>> begin2_;
     set_state state_ = set_state::first;
 
     constexpr void
@@ -565,11 +1064,22 @@ class set_symmetric_difference_view {
       satisfy();
     }
 
+    constexpr explicit iterator(iterator_t<Base1> first1, iterator_t<Base1> current1,
+                                sentinel_t<Base1> end1, iterator_t<Base2> first2,
+                                iterator_t<Base2> current2, sentinel_t<Base2> end2)
+      requires reversible
+      : iterator(std::move(current1), std::move(end1), std::move(current2), std::move(end2)) {
+      begin1_ = std::move(first1);
+      begin2_ = std::move(first2);
+    }
+
    public:
     using value_type = __detail::__concat_value_t<Base1, Base2>;
     using difference_type = common_type_t<range_difference_t<Base1>, range_difference_t<Base2>>;
-    using iterator_concept = conditional_t<forward_range<Base1> && forward_range<Base2>,
-                                           forward_iterator_tag, input_iterator_tag>;
+    using iterator_concept =
+      conditional_t<reversible, bidirectional_iterator_tag,
+                    conditional_t<forward_range<Base1> && forward_range<Base2>,
+                                  forward_iterator_tag, input_iterator_tag>>;
 
     iterator()
       requires default_initializable<iterator_t<Base1>> && default_initializable<iterator_t<Base2>>
@@ -584,7 +1094,12 @@ class set_symmetric_difference_view {
         end1_(std::move(i.end1)),
         current2_(std::move(i.current2_)),
         end2_(std::move(i.end2)),
-        state_(i.state_) { }
+        state_(i.state_) {
+      if constexpr (reversible && iterator<!Const>::reversible) {
+        begin1_ = std::move(i.begin1_);
+        begin2_ = std::move(i.begin2_);
+      }
+    }
 
     constexpr __detail::__concat_reference_t<Base1, Base2>
     operator*() const {
@@ -623,6 +1138,58 @@ class set_symmetric_difference_view {
       return tmp;
     }
 
+    // Steps back through the greatest key before the cursors. Its elements pair off by rank, and
+    // the surplus of whichever input holds more of them is what the view yields.
+    constexpr iterator&
+    operator--()
+      requires reversible
+    {
+      while (true) {
+        auto&& x = __detail::__last_before(begin1_, current1_, begin2_, current2_);
+        auto start1 = current1_;
+        const auto count1 = __detail::__retreat_run(begin1_, start1, x);
+        auto start2 = current2_;
+        const auto count2 = __detail::__retreat_run(begin2_, start2, x);
+        if (count1 > count2) {
+          --current1_;
+          state_ = current2_ == end2_ ? set_state::only_first : set_state::first;
+          return *this;
+        }
+        if (count2 > count1) {
+          --current2_;
+          state_ = current1_ == end1_ ? set_state::only_second : set_state::second;
+          return *this;
+        }
+        current1_ = std::move(start1);
+        current2_ = std::move(start2);
+      }
+    }
+
+    constexpr iterator
+    operator--(int)
+      requires reversible
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    // Moves to the first element not less than target, skipping ahead in both inputs rather than
+    // stepping through the elements in between.
+    template<class Key>
+      requires totally_ordered_with<range_reference_t<Base1>, const Key&> &&
+               totally_ordered_with<range_reference_t<Base2>, const Key&>
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel || !(**this < target))
+        return;
+      ranges::less less;
+      identity proj;
+      __detail::__seek_to(less, proj, current1_, end1_, target);
+      __detail::__seek_to(less, proj, current2_, end2_, target);
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
       requires equality_comparable<iterator_t<Base1>> && equality_comparable<iterator_t<Base2>>
@@ -643,6 +1210,23 @@ class set_symmetric_difference_view {
     }
   };
 
+  // An iterator at the start or, for reversible views, at the end of self.
+  template<bool Const>
+  static constexpr iterator<Const>
+  make_iterator(__detail::__maybe_const_t<Const, set_symmetric_difference_view>& self,
+                bool at_end) {
+    if constexpr (iterator<Const>::reversible) {
+      auto first1 = ranges::begin(self.base1_);
+      auto first2 = ranges::begin(self.base2_);
+      auto last1 = ranges::end(self.base1_);
+      auto last2 = ranges::end(self.base2_);
+      return iterator<Const>(first1, at_end ? last1 : first1, last1, first2,
+                             at_end ? last2 : first2, last2);
+    } else
+      return iterator<Const>(ranges::begin(self.base1_), ranges::end(self.base1_),
+                             ranges::begin(self.base2_), ranges::end(self.base2_));
+  }
+
  public:
   set_symmetric_difference_view()
     requires default_initializable<V1> && default_initializable<V2>
@@ -655,21 +1239,55 @@ class set_symmetric_difference_view {
   begin()
     requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
   {
-    return iterator<false>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                           ranges::end(base2_));
+    return make_iterator<false>(*this, false);
   }
 
   constexpr auto
   begin() const
     requires __detail::__set_associable_concatable<const V1, const V2>
   {
-    return iterator<true>(ranges::begin(base1_), ranges::end(base1_), ranges::begin(base2_),
-                          ranges::end(base2_));
+    return make_iterator<true>(*this, false);
   }
 
-  constexpr default_sentinel_t
-  end() const noexcept {
-    return default_sentinel;
+  constexpr auto
+  end()
+    requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
+  {
+    if constexpr (__detail::__set_reversible<V1, V2>)
+      return make_iterator<false>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  constexpr auto
+  end() const
+    requires __detail::__set_associable_concatable<const V1, const V2>
+  {
+    if constexpr (__detail::__set_reversible<const V1, const V2>)
+      return make_iterator<true>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  // No more elements than both inputs together.
+  constexpr auto
+  reserve_hint()
+    requires approximately_sized_range<V1> && approximately_sized_range<V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    return CT(hint1) + CT(hint2);
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires approximately_sized_range<const V1> && approximately_sized_range<const V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    return CT(hint1) + CT(hint2);
   }
 };
 
@@ -689,7 +1307,11 @@ struct _SetSymmetricDifference : __adaptor::_RangeAdaptor<_SetSymmetricDifferenc
     }
   constexpr auto
   operator()(R1&& r1, R2&& r2) const {
-    return set_symmetric_difference_view(std::forward<R1>(r1), std::forward<R2>(r2));
+    if constexpr (ranges::__detail::__roaring_operand<R1> &&
+                  ranges::__detail::__roaring_operand<R2>)
+      return roaring_combine_view(bit_xor<>{}, std::forward<R1>(r1), std::forward<R2>(r2));
+    else
+      return set_symmetric_difference_view(std::forward<R1>(r1), std::forward<R2>(r2));
   }
 
   using _RangeAdaptor<_SetSymmetricDifference>::operator();
@@ -701,3 +1323,372 @@ inline constexpr _SetSymmetricDifference set_symmetric_difference;
 }  // namespace views
 
 }  // namespace std::ranges
+
+namespace std::ranges {
+// Which unmatched elements an outer_merge_join_view yields besides the matched pairs.
+enum class merge_join_kind { left, right, full };
+
+// Walks both inputs once and yields one pair per step: the elements of both inputs when they are
+// equal, or one element paired with nullopt when the other input has no equal element left.
+// Equal elements are paired rank by rank, as set_symmetric_difference_view counts them.
+template<view V1, view V2>
+  requires __detail::__set_associable<V1, V2>
+class outer_merge_join_view : public view_interface<outer_merge_join_view<V1, V2>> {
+  V1 base1_ = V1();
+  V2 base2_ = V2();
+  merge_join_kind kind_ = merge_join_kind::full;
+
+  template<bool Const>
+  class iterator {
+    friend outer_merge_join_view;
+
+    using Base1 = __detail::__maybe_const_t<Const, V1>;
+    using Base2 = __detail::__maybe_const_t<Const, V2>;
+    enum class set_state { first, second, both, done };
+    iterator_t<Base1> current1_ = iterator_t<Base1>();
+    sentinel_t<Base1> end1_ = sentinel_t<Base1>();
+    iterator_t<Base2> current2_ = iterator_t<Base2>();
+    sentinel_t<Base2> end2_ = sentinel_t<Base2>();
+    // Reversible iterators also hold where the inputs start, so stepping back stops there.
+    static constexpr bool reversible = __detail::__set_reversible<Base1, Base2>;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base1>> begin1_;
+    [[no_unique_address]] __detail::__maybe_present_t<reversible, iterator_t<Base2>> begin2_;
+    merge_join_kind kind_ = merge_join_kind::full;
+    set_state state_ = set_state::done;
+
+    // Once nothing more can be yielded, both cursors sit at their ends, where a reversible end()
+    // points.
+    constexpr void
+    finish() {
+      state_ = set_state::done;
+      if constexpr (reversible) {
+        current1_ = end1_;
+        current2_ = end2_;
+      }
+    }
+
+    constexpr void
+    satisfy() {
+      while (true) {
+        const bool at_end1 = current1_ == end1_;
+        const bool at_end2 = current2_ == end2_;
+        if (at_end1 && at_end2) {
+          state_ = set_state::done;
+          return;
+        }
+        if (at_end2 || (!at_end1 && *current1_ < *current2_)) {
+          if (kind_ != merge_join_kind::right) {
+            state_ = set_state::first;
+            return;
+          }
+          if (at_end2) {
+            finish();
+            return;
+          }
+          ++current1_;
+        } else if (at_end1 || *current2_ < *current1_) {
+          if (kind_ != merge_join_kind::left) {
+            state_ = set_state::second;
+            return;
+          }
+          if (at_end1) {
+            finish();
+            return;
+          }
+          ++current2_;
+        } else {
+          state_ = set_state::both;
+          return;
+        }
+      }
+    }
+
+    constexpr explicit iterator(iterator_t<Base1> current1, sentinel_t<Base1> end1,
+                                iterator_t<Base2> current2, sentinel_t<Base2> end2,
+                                merge_join_kind kind)
+      : current1_(std::move(current1)),
+        end1_(std::move(end1)),
+        current2_(std::move(current2)),
+        end2_(std::move(end2)),
+        kind_(kind) {
+      satisfy();
+    }
+
+    constexpr explicit iterator(iterator_t<Base1> first1, iterator_t<Base1> current1,
+                                sentinel_t<Base1> end1, iterator_t<Base2> first2,
+                                iterator_t<Base2> current2, sentinel_t<Base2> end2,
+                                merge_join_kind kind)
+      requires reversible
+      : iterator(std::move(current1), std::move(end1), std::move(current2), std::move(end2),
+                 kind) {
+      begin1_ = std::move(first1);
+      begin2_ = std::move(first2);
+    }
+
+   public:
+    using reference =
+      pair<optional<__detail::__optional_element_t<range_reference_t<Base1>>>,
+           optional<__detail::__optional_element_t<range_reference_t<Base2>>>>;
+    using value_type = pair<optional<range_value_t<Base1>>, optional<range_value_t<Base2>>>;
+    using difference_type = common_type_t<range_difference_t<Base1>, range_difference_t<Base2>>;
+    using iterator_concept =
+      conditional_t<reversible, bidirectional_iterator_tag,
+                    conditional_t<forward_range<Base1> && forward_range<Base2>,
+                                  forward_iterator_tag, input_iterator_tag>>;
+
+    iterator()
+      requires default_initializable<iterator_t<Base1>> && default_initializable<iterator_t<Base2>>
+    = default;
+
+    iterator(iterator<!Const> i)
+      requires Const && convertible_to<iterator_t<V1>, iterator_t<Base1>> &&
+                 convertible_to<sentinel_t<V1>, sentinel_t<Base1>> &&
+                 convertible_to<iterator_t<V2>, iterator_t<Base2>> &&
+                 convertible_to<sentinel_t<V2>, sentinel_t<Base2>>
+      : current1_(std::move(i.current1_)),
+        end1_(std::move(i.end1_)),
+        current2_(std::move(i.current2_)),
+        end2_(std::move(i.end2_)),
+        kind_(i.kind_),
+        state_(i.state_) {
+      if constexpr (reversible && iterator<!Const>::reversible) {
+        begin1_ = std::move(i.begin1_);
+        begin2_ = std::move(i.begin2_);
+      }
+    }
+
+    constexpr reference
+    operator*() const {
+      reference result;
+      if (state_ != set_state::second)
+        result.first.emplace(*current1_);
+      if (state_ != set_state::first)
+        result.second.emplace(*current2_);
+      return result;
+    }
+
+    constexpr iterator&
+    operator++() {
+      if (state_ != set_state::second)
+        ++current1_;
+      if (state_ != set_state::first)
+        ++current2_;
+      satisfy();
+      return *this;
+    }
+
+    constexpr void
+    operator++(int) {
+      ++*this;
+    }
+
+    constexpr iterator
+    operator++(int)
+      requires forward_range<Base1> && forward_range<Base2>
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    // Steps back through the greatest key before the cursors. Its elements pair off by rank, and
+    // the surplus of whichever input holds more of them is yielded unpaired if kind_ keeps it.
+    constexpr iterator&
+    operator--()
+      requires reversible
+    {
+      while (true) {
+        auto&& x = __detail::__last_before(begin1_, current1_, begin2_, current2_);
+        auto start1 = current1_;
+        const auto count1 = __detail::__retreat_run(begin1_, start1, x);
+        auto start2 = current2_;
+        const auto count2 = __detail::__retreat_run(begin2_, start2, x);
+        if (count1 > count2) {
+          if (kind_ != merge_join_kind::right) {
+            --current1_;
+            state_ = set_state::first;
+            return *this;
+          }
+          ranges::advance(current1_, range_difference_t<Base1>(count2 - count1));
+        } else if (count2 > count1) {
+          if (kind_ != merge_join_kind::left) {
+            --current2_;
+            state_ = set_state::second;
+            return *this;
+          }
+          ranges::advance(current2_, range_difference_t<Base2>(count1 - count2));
+        } else {
+          --current1_;
+          --current2_;
+          state_ = set_state::both;
+          return *this;
+        }
+      }
+    }
+
+    constexpr iterator
+    operator--(int)
+      requires reversible
+    {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    // Moves to the first element not less than target, skipping ahead in both inputs rather than
+    // stepping through the elements in between.
+    template<class Key>
+      requires totally_ordered_with<range_reference_t<Base1>, const Key&> &&
+               totally_ordered_with<range_reference_t<Base2>, const Key&>
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel)
+        return;
+      if (state_ == set_state::second ? !(*current2_ < target) : !(*current1_ < target))
+        return;
+      ranges::less less;
+      identity proj;
+      __detail::__seek_to(less, proj, current1_, end1_, target);
+      __detail::__seek_to(less, proj, current2_, end2_, target);
+      satisfy();
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y)
+      requires equality_comparable<iterator_t<Base1>> && equality_comparable<iterator_t<Base2>>
+    {
+      return x.current1_ == y.current1_ && x.current2_ == y.current2_;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, default_sentinel_t) {
+      return x.state_ == set_state::done;
+    }
+  };
+
+  // An iterator at the start or, for reversible views, at the end of self.
+  template<bool Const>
+  static constexpr iterator<Const>
+  make_iterator(__detail::__maybe_const_t<Const, outer_merge_join_view>& self, bool at_end) {
+    if constexpr (iterator<Const>::reversible) {
+      auto first1 = ranges::begin(self.base1_);
+      auto first2 = ranges::begin(self.base2_);
+      auto last1 = ranges::end(self.base1_);
+      auto last2 = ranges::end(self.base2_);
+      return iterator<Const>(first1, at_end ? last1 : first1, last1, first2,
+                             at_end ? last2 : first2, last2, self.kind_);
+    } else
+      return iterator<Const>(ranges::begin(self.base1_), ranges::end(self.base1_),
+                             ranges::begin(self.base2_), ranges::end(self.base2_), self.kind_);
+  }
+
+ public:
+  outer_merge_join_view()
+    requires default_initializable<V1> && default_initializable<V2>
+  = default;
+
+  constexpr explicit outer_merge_join_view(V1 base1, V2 base2,
+                                           merge_join_kind kind = merge_join_kind::full)
+    : base1_(std::move(base1)), base2_(std::move(base2)), kind_(kind) { }
+
+  constexpr merge_join_kind
+  kind() const noexcept {
+    return kind_;
+  }
+
+  constexpr auto
+  begin()
+    requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
+  {
+    return make_iterator<false>(*this, false);
+  }
+
+  constexpr auto
+  begin() const
+    requires __detail::__set_associable<const V1, const V2>
+  {
+    return make_iterator<true>(*this, false);
+  }
+
+  constexpr auto
+  end()
+    requires(!__detail::__simple_view<V1> || __detail::__simple_view<V2>)
+  {
+    if constexpr (__detail::__set_reversible<V1, V2>)
+      return make_iterator<false>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  constexpr auto
+  end() const
+    requires __detail::__set_associable<const V1, const V2>
+  {
+    if constexpr (__detail::__set_reversible<const V1, const V2>)
+      return make_iterator<true>(*this, true);
+    else
+      return default_sentinel;
+  }
+
+  // No more elements than the inputs whose unmatched elements are kept.
+  constexpr auto
+  reserve_hint()
+    requires approximately_sized_range<V1> && approximately_sized_range<V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    if (kind_ == merge_join_kind::left)
+      return CT(hint1);
+    if (kind_ == merge_join_kind::right)
+      return CT(hint2);
+    return CT(CT(hint1) + CT(hint2));
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires approximately_sized_range<const V1> && approximately_sized_range<const V2>
+  {
+    auto hint1 = ranges::reserve_hint(base1_);
+    auto hint2 = ranges::reserve_hint(base2_);
+    using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hint1), decltype(hint2)>>;
+    if (kind_ == merge_join_kind::left)
+      return CT(hint1);
+    if (kind_ == merge_join_kind::right)
+      return CT(hint2);
+    return CT(CT(hint1) + CT(hint2));
+  }
+};
+
+template<class R1, class R2>
+outer_merge_join_view(R1&&, R2&&) -> outer_merge_join_view<views::all_t<R1>, views::all_t<R2>>;
+
+template<class R1, class R2>
+outer_merge_join_view(R1&&, R2&&, merge_join_kind)
+  -> outer_merge_join_view<views::all_t<R1>, views::all_t<R2>>;
+
+template<class V1, class V2>
+constexpr bool enable_borrowed_range<outer_merge_join_view<V1, V2>> =
+  enable_borrowed_range<V1> && enable_borrowed_range<V2>;
+
+namespace views {
+// outer_merge_join(r1, r2[, kind]) or r1 | outer_merge_join(r2, kind)
+struct _OuterMergeJoin : __adaptor::_RangeAdaptor<_OuterMergeJoin> {
+  template<class R1, class R2>
+    requires requires(R1&& r1, R2&& r2) {
+      outer_merge_join_view(std::forward<R1>(r1), std::forward<R2>(r2), merge_join_kind::full);
+    }
+  constexpr auto
+  operator()(R1&& r1, R2&& r2, merge_join_kind kind = merge_join_kind::full) const {
+    return outer_merge_join_view(std::forward<R1>(r1), std::forward<R2>(r2), kind);
+  }
+
+  using _RangeAdaptor<_OuterMergeJoin>::operator();
+  static constexpr int _S_arity = 3;
+  template<class R2, class Kind>
+  static constexpr bool _S_has_simple_extra_args = (view<R2> && copy_constructible<R2>);
+};
+inline constexpr _OuterMergeJoin outer_merge_join;
+}  // namespace views
+
+}  // namespace std::ranges
@@ -1,76 +1,136 @@
 #include <ranges>
 
+#include "concepts.h"
+#include "roaring.hpp"
+#include "set_kernels.h"
+
 namespace std::ranges {
-template<class Comp, input_range V1, input_range V2>
-  requires view<V1> && view<V2> && is_object_v<Comp> &&
-  indirect_strict_weak_order<Comp, iterator_t<V1>, iterator_t<V2>>
-class set_difference_view : public view_interface<set_difference_view<Comp, V1, V2>> {
-  V1 base1_ = V1();             // exposition only
-  V2 base2_ = V2();             // exposition only
-  __detail::__box<Comp> comp_;  // exposition only
+// The elements of the first view that are not in the union of the others.
+template<class Comp, class Proj, input_range... Views>
+  requires(view<Views> && ...) && (sizeof...(Views) > 0) && is_object_v<Comp> &&
+  is_object_v<Proj> && __detail::__pairwise_projected_set_order<Comp, Proj, Views...>
+class set_difference_view : public view_interface<set_difference_view<Comp, Proj, Views...>> {
+  [[no_unique_address]] __detail::__box<Comp> comp_;  // exposition only
+  [[no_unique_address]] __detail::__box<Proj> proj_;  // exposition only
+  [[no_unique_address]] tuple<Views...> views_;       // exposition only
 
   // [range.set.difference.iterator], class set_difference_view::iterator
   class iterator {
     friend set_difference_view;
 
-    iterator_t<V1> current1_ = iterator_t<V1>();  // exposition only
-    iterator_t<V2> current2_ = iterator_t<V2>();  // exposition only
+    tuple<iterator_t<Views>...> current_;  // exposition only
+    tuple<sentinel_t<Views>...> end_;      // exposition only
+    [[no_unique_address]] tuple<
+      __detail::__key_cache<Proj, iterator_t<Views>>...> keys_;  // exposition only
     set_difference_view* parent_ = nullptr;
 
+    // With a single subtrahend under ranges::less or compare_three_way, contiguous word-sized
+    // inputs are compared a block at a time by a vector kernel that buffers the surviving
+    // positions of the first input.
+    static constexpr bool use_kernel = sizeof...(Views) == 2 &&
+      __detail::__simd_set_comparator<Comp> && same_as<Proj, identity> &&
+      __detail::__simd_set_operable<Views...[0], Views...[sizeof...(Views) - 1]>;
+    [[no_unique_address]] __detail::__maybe_present_t<
+      use_kernel, __detail::__set_block_buffer<range_value_t<Views...[0]>>> buffer_;
+
+    template<size_t N>
     constexpr void
-    satisfy() {  // exposition only
-      while (true) {
-        if (current1_ == ranges::end(parent_->base1_))
-          return;
-        if (current2_ == ranges::end(parent_->base2_))
-          return;
-        if (std::__invoke(*parent_->comp_, *current1_, *current2_))
-          return;
-        if (std::__invoke(*parent_->comp_, *current2_, *current1_))
-          ++current2_;
-        else {
-          ++current1_;
-          ++current2_;
+    refresh() {  // exposition only
+      std::get<N>(keys_).refresh(*parent_->proj_, std::get<N>(current_), std::get<N>(end_));
+    }
+
+    template<size_t N>
+    constexpr decltype(auto)
+    key() const {  // exposition only
+      return std::get<N>(keys_).get(std::get<N>(current_));
+    }
+
+    // Moves every other cursor up to the first one's key, skipping ahead independently, and
+    // reports whether any of them holds that key. Each one that does gives up one element.
+    constexpr bool
+    excluded() {  // exposition only
+      bool found = false;
+      template for (constexpr size_t N : views::iota(1uz, sizeof...(Views))) {
+        auto& other = std::get<N>(current_);
+        weak_ordering order = weak_ordering::greater;
+        while (other != std::get<N>(end_)) {
+          order = __detail::__set_compare(*parent_->comp_, key<N>(), key<0>());
+          if (order >= 0)
+            break;
+          __detail::__seek_to(*parent_->comp_, *parent_->proj_, other, std::get<N>(end_),
+                              key<0>());
+          refresh<N>();
+        }
+        if (other != std::get<N>(end_) && order == 0) {
+          ++other;
+          refresh<N>();
+          found = true;
         }
       }
+      return found;
+    }
+
+    constexpr void
+    satisfy() {  // exposition only
+      if constexpr (use_kernel) {
+        buffer_.template satisfy<__detail::__set_kernel_op::difference>(
+          std::get<0>(current_), std::get<0>(end_), std::get<1>(current_), std::get<1>(end_));
+        return;
+      }
+      auto& first = std::get<0>(current_);
+      while (first != std::get<0>(end_) && excluded()) {
+        ++first;
+        refresh<0>();
+      }
     }
 
-    constexpr iterator(set_difference_view* parent,
-                       iterator_t<V1> current1,  // exposition only
-                       iterator_t<V2> current2)
-      : parent_(parent), current1_(std::move(current1)), current2_(std::move(current2)) {
+    constexpr explicit iterator(set_difference_view* parent, tuple<iterator_t<Views>...> current)
+      : parent_(parent),
+        current_(std::move(current)),
+        end_(__detail::__tuple_transform(ranges::end, parent->views_)) {
+      if constexpr (use_kernel)
+        buffer_.start(std::get<0>(current_));
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
       satisfy();
     }
 
    public:
     // using iterator_category = see below;  // not always present
-    using iterator_concept = conditional_t<forward_range<V1> && forward_range<V2>,
-                                           forward_iterator_tag, input_iterator_tag>;
-    using value_type = range_value_t<V1>;
-    using difference_type = range_difference_t<V1>;
+    // Forward only; for two bidirectional common inputs the set_algo.hpp view can step back.
+    using iterator_concept =
+      conditional_t<(forward_range<Views> && ...), forward_iterator_tag, input_iterator_tag>;
+    using value_type = range_value_t<Views...[0]>;
+    using difference_type = range_difference_t<Views...[0]>;
 
     iterator()
-      requires default_initializable<iterator_t<V1>> && default_initializable<iterator_t<V2>>
+      requires(default_initializable<iterator_t<Views>> && ...)
     = default;
 
-    constexpr iterator_t<V1>
+    constexpr iterator_t<Views...[0]>
     base() && {
-      return std::move(current1_);
+      return std::move(std::get<0>(current_));
     }
 
-    constexpr const iterator_t<V1>&
+    constexpr const iterator_t<Views...[0]>&
     base() const& noexcept {
-      return current1_;
+      return std::get<0>(current_);
     }
 
     constexpr decltype(auto)
     operator*() const {
-      return *current1_;
+      return *std::get<0>(current_);
     }
 
     constexpr iterator&
     operator++() {
-      ++current1_;
+      if constexpr (use_kernel)
+        buffer_.pop();
+      else {
+        ++std::get<0>(current_);
+        refresh<0>();
+      }
       satisfy();
       return *this;
     }
@@ -82,94 +142,149 @@ class set_difference_view : public view_interface<set_difference_view<Comp, V1,
 
     constexpr iterator
     operator++(int)
-      requires forward_range<V1> && forward_range<V2>
+      requires(forward_range<Views> && ...)
     {
       auto tmp = *this;
       ++*this;
       return tmp;
     }
 
+    // Moves to the first element whose key is not less than target, skipping ahead in every input
+    // rather than stepping through the elements in between.
+    template<class Key>
+      requires(__detail::__set_order<Comp&, __detail::__key_reference_t<Proj, iterator_t<Views>>,
+                                     const Key&> &&
+               ...)
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel || !__detail::__set_less(*parent_->comp_, key<0>(), target))
+        return;
+      if constexpr (use_kernel) {
+        if (buffer_.skip(std::get<0>(current_), target))
+          return;
+      }
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      }
+      if constexpr (use_kernel)
+        buffer_.start(std::get<0>(current_));
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
-      requires forward_range<V1> && forward_range<V2>
+      requires(forward_range<Views> && ...)
     {
-      return x.current1_ == y.current1_ && x.current2_ == y.current2_;
+      // The kernel may leave the subtrahend cursor anywhere up to where it stopped reading.
+      if constexpr (use_kernel)
+        return std::get<0>(x.current_) == std::get<0>(y.current_);
+      else
+        return x.current_ == y.current_;
     }
 
     friend constexpr bool
     operator==(const iterator& x, default_sentinel_t) {
-      return x.current1_ == ranges::end(x.parent_->base1_);
+      return std::get<0>(x.current_) == std::get<0>(x.end_);
     }
 
     friend constexpr decltype(auto)
-    iter_move(const iterator& i) noexcept(noexcept(ranges::iter_move(i.current1_))) {
-      return ranges::iter_move(i.current1_);
+    iter_move(const iterator& i) noexcept(noexcept(ranges::iter_move(std::get<0>(i.current_)))) {
+      return ranges::iter_move(std::get<0>(i.current_));
     }
   };  // exposition only
 
+  static constexpr bool caches_begin = (forward_range<Views> && ...);
+  [[no_unique_address]] __detail::__maybe_present_t<
+    caches_begin, __detail::__non_propagating_cache<iterator>> begin_;  // exposition only
+
  public:
-  set_difference_view()
-    requires default_initializable<V1> && default_initializable<V2>
-  = default;
-
-  constexpr explicit set_difference_view(Comp comp, V1 base1, V2 base2)
-    : comp_(std::move(comp)), base1_(std::move(base1)), base2_(std::move(base2)) {
-    // __glibcxx_assert(ranges::is_sorted(base1_));
-    // __glibcxx_assert(ranges::is_sorted(base2_));
+  set_difference_view() = default;
+
+  constexpr explicit set_difference_view(Comp comp, Views... bases)
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...) { }
+
+  constexpr explicit set_difference_view(Comp comp, Proj proj, Views... bases)
+    : comp_(std::move(comp)), proj_(std::move(proj)), views_(std::move(bases)...) {
+    // __glibcxx_assert((ranges::is_sorted(bases, *comp_, *proj_) && ...));
   }
 
-  constexpr V1
-  base() const&
-    requires copy_constructible<V1>
+  constexpr Views...[0] base() const&
+    requires copy_constructible<Views...[0]>
   {
-    return base1_;
+    return std::get<0>(views_);
   }
 
-  constexpr V1
-  base() && {
-    return std::move(base1_);
-  }
+  constexpr Views...[0] base() && { return std::move(std::get<0>(views_)); }
 
   constexpr iterator
   begin() {
-    return iterator(this, ranges::begin(base1_), ranges::begin(base2_));
+    if constexpr (caches_begin) {
+      if (!begin_._M_has_value())
+        begin_._M_emplace(iterator(this, __detail::__tuple_transform(ranges::begin, views_)));
+      return *begin_;
+    } else
+      return iterator(this, __detail::__tuple_transform(ranges::begin, views_));
   }
 
   constexpr default_sentinel_t
   end() const noexcept {
     return default_sentinel;
   }
+
+  // No more elements than the first input.
+  constexpr auto
+  reserve_hint()
+    requires approximately_sized_range<Views...[0]>
+  {
+    return ranges::reserve_hint(std::get<0>(views_));
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires approximately_sized_range<const Views...[0]>
+  {
+    return ranges::reserve_hint(std::get<0>(views_));
+  }
 };
 
-template<class Comp, class R1, class R2>
-set_difference_view(Comp, R1&&, R2&&)
-  -> set_difference_view<Comp, views::all_t<R1>, views::all_t<R2>>;
+template<class Comp, class... Rs>
+set_difference_view(Comp, Rs&&...) -> set_difference_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!range<Proj>)
+set_difference_view(Comp, Proj, Rs&&...)
+  -> set_difference_view<Comp, Proj, views::all_t<Rs>...>;
 
 namespace views {
 namespace __detail {
-template<class Comp, class R1, class R2>
+template<class Comp, class... Args>
 concept __can_set_difference_view =
-  requires { set_difference_view(std::declval<Comp>(), std::declval<R1>(), std::declval<R2>()); };
+  requires { set_difference_view(std::declval<Comp>(), std::declval<Args>()...); };
 }  // namespace __detail
 
 struct SetDifferenceBy {
-  template<class Comp, class R1, class R2>
-    requires __detail::__can_set_difference_view<Comp, R1, R2>
+  template<class Comp, class... Args>
+    requires __detail::__can_set_difference_view<Comp, Args...>
   constexpr auto
-  operator() [[nodiscard]] (Comp&& comp, R1&& r1, R2&& r2) const {
-    return set_difference_view(std::forward<Comp>(comp), std::forward<R1>(r1),
-                               std::forward<R2>(r2));
+  operator() [[nodiscard]] (Comp&& comp, Args&&... args) const {
+    return set_difference_view(std::forward<Comp>(comp), std::forward<Args>(args)...);
   }
 };
 
 inline constexpr SetDifferenceBy set_difference_by;
 
 struct SetDifference {
-  template<class R1, class R2>
-    requires __detail::__can_set_difference_view<ranges::less, R1, R2>
+  template<class... Rs>
+    requires __detail::__can_set_difference_view<ranges::less, Rs...>
   constexpr auto
-  operator() [[nodiscard]] (R1&& r1, R2&& r2) const {
-    return set_difference_view(ranges::less{}, std::forward<R1>(r1), std::forward<R2>(r2));
+  operator() [[nodiscard]] (Rs&&... rs) const {
+    if constexpr ((ranges::__detail::__roaring_operand<Rs> && ...))
+      return roaring_combine_view(minus<>{}, std::forward<Rs>(rs)...);
+    else
+      return set_difference_view(ranges::less{}, std::forward<Rs>(rs)...);
   }
 };
 
@@ -1,11 +1,15 @@
 #include "concepts.hpp"
+#include "roaring.hpp"
+#include "set_kernels.h"
 
 namespace std::ranges {
-template<class Comp, input_range... Views>
+template<class Comp, class Proj, input_range... Views>
   requires(view<Views> && ...) && (sizeof...(Views) > 0) && is_object_v<Comp> &&
-  __detail::__pairwise_indirect_strict_weak_order<Comp, Views...>
-class set_intersection_view : public view_interface<set_intersection_view<Comp, Views...>> {
+  is_object_v<Proj> && __detail::__pairwise_projected_set_order<Comp, Proj, Views...>
+class set_intersection_view
+  : public view_interface<set_intersection_view<Comp, Proj, Views...>> {
   [[no_unique_address]] __detail::__box<Comp> comp_;
+  [[no_unique_address]] __detail::__box<Proj> proj_;
   [[no_unique_address]] tuple<Views...> views_;
 
   // TODO: iterator_category
@@ -13,31 +17,67 @@ class set_intersection_view : public view_interface<set_intersection_view<Comp,
     friend set_intersection_view;
 
     tuple<iterator_t<Views>...> current_;
+    tuple<sentinel_t<Views>...> end_;
+    [[no_unique_address]] tuple<__detail::__key_cache<Proj, iterator_t<Views>>...> keys_;
     set_intersection_view* parent_ = nullptr;
 
+    // Two contiguous word-sized inputs under ranges::less or compare_three_way are merged a block
+    // at a time by a vector kernel that buffers the matching positions of the first input.
+    static constexpr bool use_kernel = sizeof...(Views) == 2 &&
+      __detail::__simd_set_comparator<Comp> && same_as<Proj, identity> &&
+      __detail::__simd_set_operable<Views...[0], Views...[sizeof...(Views) - 1]>;
+    [[no_unique_address]] __detail::__maybe_present_t<
+      use_kernel, __detail::__set_block_buffer<range_value_t<Views...[0]>>> buffer_;
+
     constexpr explicit iterator(set_intersection_view* parent, tuple<iterator_t<Views>...> current)
-      : parent_(parent), current_(std::move(current)) {
+      : parent_(parent),
+        current_(std::move(current)),
+        end_(__detail::__tuple_transform(ranges::end, parent->views_)) {
+      if constexpr (use_kernel)
+        buffer_.start(std::get<0>(current_));
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
       satisfy();
     }
 
+    template<size_t N>
+    constexpr void
+    refresh() {
+      std::get<N>(keys_).refresh(*parent_->proj_, std::get<N>(current_), std::get<N>(end_));
+    }
+
+    template<size_t N>
+    constexpr decltype(auto)
+    key() const {
+      return std::get<N>(keys_).get(std::get<N>(current_));
+    }
+
     constexpr bool
     try_satisfy() {
       auto& first = std::get<0>(current_);
-      if (first == ranges::end(std::get<0>(parent_->views_)))
+      if (first == std::get<0>(end_))
         return true;
 
       template for (constexpr size_t N : views::iota(1uz, sizeof...(Views))) {
         auto& other = std::get<N>(current_);
         while (true) {
-          if (other == ranges::end(std::get<N>(parent_->views_)))
+          if (other == std::get<N>(end_))
             return true;
-          if (std::__invoke(*parent_->comp_, *first, *other)) {
-            ++first;
+          const weak_ordering order = __detail::__set_compare(*parent_->comp_, key<0>(), key<N>());
+          // A cursor that falls behind leaps straight to the other's key: it gallops, or asks
+          // an input that can seek, such as a nested set view, to skip ahead itself.
+          if (order < 0) {
+            __detail::__seek_to(*parent_->comp_, *parent_->proj_, first, std::get<0>(end_),
+                                key<N>());
+            refresh<0>();
             return false;
           }
-          if (std::__invoke(*parent_->comp_, *other, *first))
-            ++other;
-          else
+          if (order > 0) {
+            __detail::__seek_to(*parent_->comp_, *parent_->proj_, other, std::get<N>(end_),
+                                key<0>());
+            refresh<N>();
+          } else
             break;
         }
       }
@@ -46,11 +86,17 @@ class set_intersection_view : public view_interface<set_intersection_view<Comp,
 
     constexpr void
     satisfy() {
+      if constexpr (use_kernel) {
+        buffer_.template satisfy<__detail::__set_kernel_op::intersection>(
+          std::get<0>(current_), std::get<0>(end_), std::get<1>(current_), std::get<1>(end_));
+        return;
+      }
       while (!try_satisfy())
         ;
     }
 
    public:
+    // Forward only; the binary view in set_algo.hpp steps back over bidirectional common inputs.
     using iterator_concept =
       conditional_t<(forward_range<Views> && ...), forward_iterator_tag, input_iterator_tag>;
     using value_type = range_value_t<Views...[0]>;
@@ -75,7 +121,14 @@ class set_intersection_view : public view_interface<set_intersection_view<Comp,
 
     constexpr iterator&
     operator++() {
-      __detail::__tuple_for_each([](auto& i) { ++i; }, current_);
+      if constexpr (use_kernel)
+        buffer_.pop();
+      else {
+        template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+          ++std::get<N>(current_);
+          refresh<N>();
+        }
+      }
       satisfy();
       return *this;
     }
@@ -94,17 +147,48 @@ class set_intersection_view : public view_interface<set_intersection_view<Comp,
       return tmp;
     }
 
+    // Moves to the first element whose key is not less than target, skipping ahead in every input
+    // rather than stepping through the elements in between.
+    template<class Key>
+      requires(__detail::__set_order<Comp&, __detail::__key_reference_t<Proj, iterator_t<Views>>,
+                                     const Key&> &&
+               ...)
+    constexpr void
+    seek(const Key& target) {
+      if (*this == default_sentinel || !__detail::__set_less(*parent_->comp_, key<0>(), target))
+        return;
+      if constexpr (use_kernel) {
+        if (buffer_.skip(std::get<0>(current_), target))
+          return;
+      }
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      }
+      if constexpr (use_kernel)
+        buffer_.start(std::get<0>(current_));
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
       requires(forward_range<Views> && ...)
     {
-      return x.current_ == y.current_;
+      // The kernel may leave the second cursor anywhere up to where it stopped reading.
+      if constexpr (use_kernel)
+        return std::get<0>(x.current_) == std::get<0>(y.current_);
+      else
+        return x.current_ == y.current_;
     }
 
     friend constexpr bool
     operator==(const iterator& it, default_sentinel_t) {
+      // Buffered matches remain after the kernel has drained the second input.
+      if constexpr (use_kernel)
+        return std::get<0>(it.current_) == std::get<0>(it.end_);
       template for (constexpr size_t N : views::indices(sizeof...(Views))) {
-        if (std::get<N>(it.current_) == ranges::end(std::get<N>(it.parent_->views_)))
+        if (std::get<N>(it.current_) == std::get<N>(it.end_))
           return true;
       }
       return false;
@@ -116,10 +200,17 @@ class set_intersection_view : public view_interface<set_intersection_view<Comp,
     }
   };
 
+  static constexpr bool caches_begin = (forward_range<Views> && ...);
+  [[no_unique_address]] __detail::__maybe_present_t<
+    caches_begin, __detail::__non_propagating_cache<iterator>> begin_;
+
  public:
   set_intersection_view() = default;
   constexpr explicit set_intersection_view(Comp comp, Views... bases)
-    : comp_(std::move(comp)), views_(std::move(bases)...) { }
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...) { }
+  constexpr explicit set_intersection_view(Comp comp, Proj proj, Views... bases)
+    : comp_(std::move(comp)), proj_(std::move(proj)), views_(std::move(bases)...) { }
 
   constexpr Views...[0] base() const&
     requires copy_constructible<Views...[0]>
@@ -131,8 +222,12 @@ class set_intersection_view : public view_interface<set_intersection_view<Comp,
 
   constexpr iterator
   begin() {
-    // TODO: cache begin
-    return iterator(this, __detail::__tuple_transform(ranges::begin, views_));
+    if constexpr (caches_begin) {
+      if (!begin_._M_has_value())
+        begin_._M_emplace(iterator(this, __detail::__tuple_transform(ranges::begin, views_)));
+      return *begin_;
+    } else
+      return iterator(this, __detail::__tuple_transform(ranges::begin, views_));
   }
 
   constexpr auto
@@ -140,23 +235,40 @@ class set_intersection_view : public view_interface<set_intersection_view<Comp,
     return default_sentinel;
   }
 
-  // constexpr auto
-  // reserve_hint()
-  //   requires approximately_sized_range<Views...[0]>
-  // {
-  //   return ranges::reserve_hint(std::get<0>(views_));
-  // }
-
-  // constexpr auto
-  // reserve_hint() const
-  //   requires approximately_sized_range<const Views...[0]>
-  // {
-  //   return ranges::reserve_hint(std::get<0>(views_));
-  // }
+  // No more elements than the shortest input.
+  constexpr auto
+  reserve_hint()
+    requires(approximately_sized_range<Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return ranges::min({CT(hints)...});
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires(approximately_sized_range<const Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return ranges::min({CT(hints)...});
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
 };
 
 template<class Comp, class... Rs>
-set_intersection_view(Comp, Rs&&...) -> set_intersection_view<Comp, views::all_t<Rs>...>;
+set_intersection_view(Comp, Rs&&...)
+  -> set_intersection_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!range<Proj>)
+set_intersection_view(Comp, Proj, Rs&&...)
+  -> set_intersection_view<Comp, Proj, views::all_t<Rs>...>;
 
 namespace views {
 namespace __detail {
@@ -181,7 +293,10 @@ struct SetIntersection {
     requires __detail::__can_set_intersection_view<ranges::less, Rs...>
   constexpr auto
   operator() [[nodiscard]] (Rs&&... rs) const {
-    return set_intersection_view(ranges::less{}, std::forward<Rs>(rs)...);
+    if constexpr ((ranges::__detail::__roaring_operand<Rs> && ...))
+      return roaring_combine_view(bit_and<>{}, std::forward<Rs>(rs)...);
+    else
+      return set_intersection_view(ranges::less{}, std::forward<Rs>(rs)...);
   }
 };
 
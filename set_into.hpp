@@ -0,0 +1,1034 @@
+#pragma once
+#include <algorithm>
+#include <barrier>
+#include <exception>
+#include <execution>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "concepts.h"
+#include "merge_tree.h"
+#include "set_kernels.h"
+#include "set_symmetric_difference.hpp"
+
+namespace std::ranges {
+namespace __detail {
+template<class O, class... Rs>
+concept __set_outputtable =
+  weakly_incrementable<O> && (indirectly_copyable<iterator_t<Rs>, O> && ...);
+
+enum class __align_result { aligned, retry, exhausted };
+
+// One round of the K-way intersection merge: brings every cursor up to the first one's key, or
+// moves the first one forward if some cursor has overtaken it.
+template<class Comp, class Proj, class... Its, class... Sents>
+constexpr __align_result
+__align_intersection(Comp& comp, Proj& proj, tuple<Its...>& current,
+                     const tuple<Sents...>& last) {
+  auto& first = std::get<0>(current);
+  if (first == std::get<0>(last))
+    return __align_result::exhausted;
+  template for (constexpr size_t N : views::iota(1uz, sizeof...(Its))) {
+    auto& other = std::get<N>(current);
+    while (true) {
+      if (other == std::get<N>(last))
+        return __align_result::exhausted;
+      const weak_ordering order =
+        __set_compare(comp, std::__invoke(proj, *first), std::__invoke(proj, *other));
+      if (order < 0) {
+        __seek_to(comp, proj, first, std::get<0>(last), std::__invoke(proj, *other));
+        return __align_result::retry;
+      }
+      if (order > 0)
+        __seek_to(comp, proj, other, std::get<N>(last), std::__invoke(proj, *first));
+      else
+        break;
+    }
+  }
+  return __align_result::aligned;
+}
+
+// Inputs whose elements the K-way merges can compare through one common reference type, so that
+// a comparison between two cursors addressed by runtime index is a single call.
+template<class Comp, class Proj, class... Rs>
+concept __merge_indexable = requires { typename common_reference_t<range_reference_t<Rs>...>; } &&
+  __set_order<Comp&, invoke_result_t<Proj&, common_reference_t<range_reference_t<Rs>...>>>;
+
+// The group filter of the K-way union, which keeps every group without counting it.
+struct __every_group {
+  constexpr bool
+  operator()(size_t) const noexcept {
+    return true;
+  }
+};
+
+// The K-way merge shared by the eager union and symmetric difference, over cursors addressed by
+// runtime index: each access is one __visit_index table call, so the loop is instantiated once
+// however many inputs there are. Past __merge_tree_threshold inputs the least cursor comes from
+// a __tournament_tree, below it from a linear scan. The cursors holding the least key form a
+// group that gives up one element each per step; the element of the group's lowest-numbered
+// input is written if keep accepts the group's size.
+template<class Comp, class Proj, class O, class Keep, class... Rs>
+constexpr O
+__merge_groups(Comp& comp, Proj& proj, O result, Keep keep, Rs&... rs) {
+  constexpr size_t K = sizeof...(Rs);
+  auto current = tuple(ranges::begin(rs)...);
+  auto last = tuple(ranges::end(rs)...);
+  const auto at_end = [&](size_t i) {
+    return __visit_index<K>(i, [&]<size_t N> { return std::get<N>(current) == std::get<N>(last); });
+  };
+  // Without a common reference type each pair of inputs is compared through its own types.
+  const auto with_keys = [&](size_t i, size_t j, auto f) {
+    if constexpr (__merge_indexable<Comp, Proj, Rs...>) {
+      using merged = common_reference_t<range_reference_t<Rs>...>;
+      const auto key = [&](size_t k) -> merged {
+        return __visit_index<K>(k, [&]<size_t N> -> merged { return *std::get<N>(current); });
+      };
+      return f(std::__invoke(proj, key(i)), std::__invoke(proj, key(j)));
+    } else
+      return __visit_index<K>(i, [&]<size_t A> {
+        return __visit_index<K>(j, [&]<size_t B> {
+          return f(std::__invoke(proj, *std::get<A>(current)),
+                   std::__invoke(proj, *std::get<B>(current)));
+        });
+      });
+  };
+  const auto less = [&](size_t i, size_t j) {
+    return with_keys(i, j, [&](auto&& x, auto&& y) {
+      return __set_less(comp, std::forward<decltype(x)>(x), std::forward<decltype(y)>(y));
+    });
+  };
+  const auto next = [&](size_t i) {
+    __visit_index<K>(i, [&]<size_t N> { ++std::get<N>(current); });
+  };
+  const auto emit = [&](size_t i) {
+    __visit_index<K>(i, [&]<size_t N> { *result = *std::get<N>(current); });
+    ++result;
+  };
+
+  if constexpr (K > __merge_tree_threshold) {
+    const auto ahead = [&](size_t i, size_t j) {
+      if (at_end(j))
+        return !at_end(i) || i < j;
+      if (at_end(i))
+        return false;
+      const weak_ordering order = with_keys(i, j, [&](auto&& x, auto&& y) {
+        return __set_compare(comp, std::forward<decltype(x)>(x), std::forward<decltype(y)>(y));
+      });
+      return order < 0 || (order == 0 && i < j);
+    };
+    __tournament_tree<K> tree;
+    tree.build(ahead);
+    while (!at_end(tree.top())) {
+      const size_t winner = tree.top();
+      tree.gather(ahead, [&](size_t i) { return !at_end(i) && !less(winner, i); });
+      if (keep(tree.group().size()))
+        emit(winner);
+      tree.release(ahead, next);
+    }
+  } else
+    while (true) {
+      size_t active = -1;
+      size_t group_size = 0;
+      for (size_t i = 0; i != K; ++i) {
+        if (at_end(i))
+          continue;
+        if (active == -1 || less(i, active)) {
+          active = i;
+          group_size = 1;
+        } else if constexpr (!same_as<Keep, __every_group>) {
+          if (!less(active, i))
+            ++group_size;
+        }
+      }
+      if (active == -1)
+        break;
+      for (size_t i = 0; i != K; ++i)
+        if (i != active && !at_end(i) && !less(active, i))
+          next(i);
+      if (keep(group_size))
+        emit(active);
+      next(active);
+    }
+  return result;
+}
+
+// Whether every element of r2 has a match in [first1, last1), pairing equal elements rank by rank
+// as std::includes does. first1 seeks to each element of r2.
+template<class Comp, class I1, class S1, class R2>
+constexpr bool
+__includes(Comp& comp, I1 first1, S1 last1, R2& r2) {
+  identity proj;
+  auto first2 = ranges::begin(r2);
+  auto last2 = ranges::end(r2);
+  for (; first2 != last2; ++first2, ++first1) {
+    __seek_to(comp, proj, first1, last1, *first2);
+    if (first1 == last1 || __set_less(comp, *first2, *first1))
+      return false;
+  }
+  return true;
+}
+
+// How a merge of two inputs pairs up their elements: `both` counts the elements matched rank by
+// rank with an equal element of the other input, `first` and `second` the inputs' lengths. Every
+// binary set operation's cardinality follows from these three numbers.
+template<class D>
+struct __set_counts {
+  D both = 0;
+  D first = 0;
+  D second = 0;
+
+  constexpr D
+  union_size() const noexcept {
+    return first + second - both;
+  }
+
+  constexpr D
+  difference_size() const noexcept {
+    return first - both;
+  }
+
+  constexpr D
+  symmetric_difference_size() const noexcept {
+    return first + second - 2 * both;
+  }
+};
+
+// Merges r1 with r2 without dereferencing for anything but comparisons. Contiguous integers under
+// ranges::less or compare_three_way go to the vector kernels; other sized random-access inputs
+// take a branchless loop that steps both indices by one comparison result. The lengths are only
+// measured if Sizes is set or come for free.
+template<bool Sizes, class Comp, class R1, class R2>
+constexpr __set_counts<common_type_t<range_difference_t<R1>, range_difference_t<R2>>>
+__count_merge(Comp comp, R1& r1, R2& r2) {
+  using D = common_type_t<range_difference_t<R1>, range_difference_t<R2>>;
+  if constexpr (__simd_set_comparator<Comp> && __simd_set_operable<R1, R2>) {
+    const auto a = ranges::data(r1);
+    const auto b = ranges::data(r2);
+    const D n1 = ranges::distance(r1);
+    const D n2 = ranges::distance(r2);
+    return {D(__set_count(a, a + n1, b, b + n2)), n1, n2};
+  } else if constexpr (random_access_range<R1> && sized_range<R1> && random_access_range<R2> &&
+                       sized_range<R2>) {
+    const auto first1 = ranges::begin(r1);
+    const auto first2 = ranges::begin(r2);
+    const D n1 = ranges::distance(r1);
+    const D n2 = ranges::distance(r2);
+    D i = 0;
+    D j = 0;
+    D both = 0;
+    while (i < n1 && j < n2) {
+      const weak_ordering order = __set_compare(comp, first1[i], first2[j]);
+      both += order == 0;
+      i += order <= 0;
+      j += order >= 0;
+    }
+    return {both, n1, n2};
+  } else {
+    auto first1 = ranges::begin(r1);
+    auto last1 = ranges::end(r1);
+    auto first2 = ranges::begin(r2);
+    auto last2 = ranges::end(r2);
+    __set_counts<D> counts;
+    while (first1 != last1 && first2 != last2) {
+      const weak_ordering order = __set_compare(comp, *first1, *first2);
+      if (order < 0) {
+        ++first1;
+        ++counts.first;
+      } else if (order > 0) {
+        ++first2;
+        ++counts.second;
+      } else {
+        ++first1;
+        ++first2;
+        ++counts.first;
+        ++counts.second;
+        ++counts.both;
+      }
+    }
+    if constexpr (Sizes) {
+      counts.first += ranges::distance(std::move(first1), std::move(last1));
+      counts.second += ranges::distance(std::move(first2), std::move(last2));
+    }
+    return counts;
+  }
+}
+
+// Inputs a parallel overload can cut into chunks and an output it can write each chunk's results
+// into at a precomputed offset.
+template<class O, class R1, class R2>
+concept __parallel_set_operable = random_access_range<R1> && sized_range<R1> &&
+  random_access_range<R2> && sized_range<R2> && random_access_iterator<O>;
+
+// Below this many input elements per chunk, starting a thread costs more than it saves.
+inline constexpr size_t __parallel_set_grain = size_t(1) << 16;
+
+// An output iterator that only counts the elements written through it.
+class __counting_output {
+  struct __sink {
+    template<class T>
+    constexpr const __sink&
+    operator=(T&&) const noexcept {
+      return *this;
+    }
+  };
+
+  ptrdiff_t count_ = 0;
+
+ public:
+  using difference_type = ptrdiff_t;
+
+  constexpr __sink
+  operator*() const noexcept {
+    return {};
+  }
+
+  constexpr __counting_output&
+  operator++() noexcept {
+    ++count_;
+    return *this;
+  }
+
+  constexpr __counting_output
+  operator++(int) noexcept {
+    auto tmp = *this;
+    ++count_;
+    return tmp;
+  }
+
+  constexpr ptrdiff_t
+  count() const noexcept {
+    return count_;
+  }
+};
+
+// Finds where the merge of [first1, first1 + n1) and [first2, first2 + n2) has taken d elements,
+// then moves that point back to the first occurrence of the key found there in both inputs. Runs
+// of equal keys, which the set operations pair up rank by rank, so never straddle two chunks.
+template<class Comp, class I1, class I2>
+constexpr pair<size_t, size_t>
+__merge_path_split(Comp& comp, I1 first1, size_t n1, I2 first2, size_t n2, size_t d) {
+  size_t lo = d > n2 ? d - n2 : 0;
+  size_t hi = std::min(d, n1);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (__set_less(comp, first2[d - mid - 1], first1[mid]))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  const size_t i = lo;
+  const size_t j = d - lo;
+  auto snap = [&](auto&& key) {
+    auto before = [&](auto&& x) { return __set_less(comp, x, key); };
+    return pair<size_t, size_t>(ranges::partition_point(first1, first1 + i, before) - first1,
+                                ranges::partition_point(first2, first2 + j, before) - first2);
+  };
+  if (i != n1 && (j == n2 || !__set_less(comp, first2[j], first1[i])))
+    return snap(first1[i]);
+  return snap(first2[j]);
+}
+
+// Calls first(k) for every k in [0, n), then between() once, then second(k) for every k. One
+// thread per k runs both passes, which a barrier separates. Rethrows the first exception; once
+// the first pass has thrown, between and the second pass are skipped.
+template<class F, class Between, class G>
+void
+__run_chunks(size_t n, F& first, Between& between, G& second) {
+  vector<exception_ptr> errors(n);
+  bool failed = false;
+  auto step = [&]() noexcept {
+    failed = ranges::any_of(errors, [](const exception_ptr& e) { return bool(e); });
+    if (!failed)
+      between();
+  };
+  barrier sync(static_cast<ptrdiff_t>(n), step);
+  auto work = [&](size_t k) {
+    try {
+      first(k);
+    } catch (...) {
+      errors[k] = current_exception();
+    }
+    sync.arrive_and_wait();
+    if (failed)
+      return;
+    try {
+      second(k);
+    } catch (...) {
+      errors[k] = current_exception();
+    }
+  };
+  {
+    vector<jthread> workers;
+    workers.reserve(n - 1);
+    for (size_t k = 1; k < n; ++k)
+      workers.emplace_back(work, k);
+    work(0);
+  }
+  for (auto& e : errors)
+    if (e)
+      rethrow_exception(e);
+}
+
+// Evaluates serial(out, r1, r2) over merge-path chunks of the two inputs: a first parallel pass
+// measures each chunk's output with size(r1, r2), a prefix sum turns the sizes into offsets and a
+// second pass writes every chunk straight into its place.
+template<class Ep, class O, class Comp, class R1, class R2, class Serial, class Size>
+O
+__parallel_set_into(O result, Comp& comp, R1& r1, R2& r2, Serial serial, Size size) {
+  const auto first1 = ranges::begin(r1);
+  const auto first2 = ranges::begin(r2);
+  const size_t n1 = ranges::size(r1);
+  const size_t n2 = ranges::size(r2);
+  using P = remove_cvref_t<Ep>;
+  size_t chunks = 1;
+  if constexpr (!same_as<P, execution::sequenced_policy> &&
+                !same_as<P, execution::unsequenced_policy>)
+    chunks = std::clamp<size_t>((n1 + n2) / __parallel_set_grain, 1,
+                                std::max(thread::hardware_concurrency(), 1u));
+  if (chunks == 1)
+    return serial(std::move(result), ranges::subrange(first1, first1 + n1),
+                  ranges::subrange(first2, first2 + n2));
+
+  vector<pair<size_t, size_t>> split(chunks + 1);
+  split[chunks] = {n1, n2};
+  for (size_t k = 1; k < chunks; ++k)
+    split[k] = __merge_path_split(comp, first1, n1, first2, n2, k * ((n1 + n2) / chunks));
+  auto part1 = [&](size_t k) {
+    return ranges::subrange(first1 + split[k].first, first1 + split[k + 1].first);
+  };
+  auto part2 = [&](size_t k) {
+    return ranges::subrange(first2 + split[k].second, first2 + split[k + 1].second);
+  };
+
+  vector<iter_difference_t<O>> offset(chunks + 1);
+  auto measure = [&](size_t k) { offset[k + 1] = size(part1(k), part2(k)); };
+  auto place = [&] { std::partial_sum(offset.begin(), offset.end(), offset.begin()); };
+  auto write = [&](size_t k) { serial(result + offset[k], part1(k), part2(k)); };
+  __run_chunks(chunks, measure, place, write);
+  return result + offset[chunks];
+}
+}  // namespace __detail
+
+// Eager counterparts of views::set_intersection_by and friends: each writes the whole result to
+// `result` in one merge loop and returns the end of the output. They take the views' inputs,
+// comparator and optional projection: set_*_into_by(result, comp, [proj,] rs...).
+
+struct SetUnionIntoBy {
+  template<class O, class Comp, class Proj, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && (!range<Proj>) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_projected_set_order<Comp, Proj, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Proj proj, Rs&&... rs) const {
+    if constexpr (sizeof...(Rs) == 2) {
+      auto [first1, first2] = tuple(ranges::begin(rs)...);
+      auto [last1, last2] = tuple(ranges::end(rs)...);
+      while (first1 != last1 && first2 != last2) {
+        const weak_ordering order = __detail::__set_compare(comp, std::__invoke(proj, *first1),
+                                                            std::__invoke(proj, *first2));
+        if (order > 0) {
+          *result = *first2;
+          ++first2;
+        } else {
+          if (order == 0)
+            ++first2;
+          *result = *first1;
+          ++first1;
+        }
+        ++result;
+      }
+      result = ranges::copy(std::move(first1), std::move(last1), std::move(result)).out;
+      return ranges::copy(std::move(first2), std::move(last2), std::move(result)).out;
+    } else
+      return __detail::__merge_groups(comp, proj, std::move(result), __detail::__every_group{},
+                                      rs...);
+  }
+
+  template<class O, class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Rs&&... rs) const {
+    return (*this)(std::move(result), std::move(comp), identity{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class Comp, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             __detail::__parallel_set_operable<O, R1, R2> &&
+             __detail::__set_outputtable<O, R1, R2> &&
+             __detail::__indirect_set_order<Comp, iterator_t<R1>, iterator_t<R2>>
+  O
+  operator()(Ep&&, O result, Comp comp, R1&& r1, R2&& r2) const {
+    return __detail::__parallel_set_into<Ep>(
+      std::move(result), comp, r1, r2,
+      [&](auto out, auto s1, auto s2) { return (*this)(std::move(out), comp, s1, s2); },
+      [&](auto s1, auto s2) { return __detail::__count_merge<true>(comp, s1, s2).union_size(); });
+  }
+};
+
+inline constexpr SetUnionIntoBy set_union_into_by;
+
+struct SetUnionInto {
+  template<class O, input_range... Rs>
+    requires requires(O result, Rs&&... rs) {
+      set_union_into_by(std::move(result), ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr O
+  operator()(O result, Rs&&... rs) const {
+    return set_union_into_by(std::move(result), ranges::less{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             requires(Ep&& policy, O result, R1&& r1, R2&& r2) {
+               set_union_into_by(std::forward<Ep>(policy), std::move(result), ranges::less{},
+                                 std::forward<R1>(r1), std::forward<R2>(r2));
+             }
+  O
+  operator()(Ep&& policy, O result, R1&& r1, R2&& r2) const {
+    return set_union_into_by(std::forward<Ep>(policy), std::move(result), ranges::less{},
+                             std::forward<R1>(r1), std::forward<R2>(r2));
+  }
+};
+
+inline constexpr SetUnionInto set_union_into;
+
+struct SetIntersectionIntoBy {
+  template<class O, class Comp, class Proj, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && (!range<Proj>) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_projected_set_order<Comp, Proj, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Proj proj, Rs&&... rs) const {
+    auto current = tuple(ranges::begin(rs)...);
+    auto last = tuple(ranges::end(rs)...);
+    while (true) {
+      switch (__detail::__align_intersection(comp, proj, current, last)) {
+        case __detail::__align_result::exhausted:
+          return result;
+        case __detail::__align_result::retry:
+          continue;
+        case __detail::__align_result::aligned:
+          break;
+      }
+      *result = *std::get<0>(current);
+      ++result;
+      __detail::__tuple_for_each([](auto& i) { ++i; }, current);
+    }
+  }
+
+  template<class O, class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Rs&&... rs) const {
+    return (*this)(std::move(result), std::move(comp), identity{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class Comp, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             __detail::__parallel_set_operable<O, R1, R2> &&
+             __detail::__set_outputtable<O, R1, R2> &&
+             __detail::__indirect_set_order<Comp, iterator_t<R1>, iterator_t<R2>>
+  O
+  operator()(Ep&&, O result, Comp comp, R1&& r1, R2&& r2) const {
+    return __detail::__parallel_set_into<Ep>(
+      std::move(result), comp, r1, r2,
+      [&](auto out, auto s1, auto s2) { return (*this)(std::move(out), comp, s1, s2); },
+      [&](auto s1, auto s2) { return __detail::__count_merge<false>(comp, s1, s2).both; });
+  }
+};
+
+inline constexpr SetIntersectionIntoBy set_intersection_into_by;
+
+struct SetIntersectionInto {
+  template<class O, input_range... Rs>
+    requires requires(O result, Rs&&... rs) {
+      set_intersection_into_by(std::move(result), ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr O
+  operator()(O result, Rs&&... rs) const {
+    return set_intersection_into_by(std::move(result), ranges::less{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             requires(Ep&& policy, O result, R1&& r1, R2&& r2) {
+               set_intersection_into_by(std::forward<Ep>(policy), std::move(result), ranges::less{},
+                                        std::forward<R1>(r1), std::forward<R2>(r2));
+             }
+  O
+  operator()(Ep&& policy, O result, R1&& r1, R2&& r2) const {
+    return set_intersection_into_by(std::forward<Ep>(policy), std::move(result), ranges::less{},
+                                    std::forward<R1>(r1), std::forward<R2>(r2));
+  }
+};
+
+inline constexpr SetIntersectionInto set_intersection_into;
+
+// The elements of the first input that are not in the union of the others, pairing equal
+// elements rank by rank as views::set_difference_by does.
+struct SetDifferenceIntoBy {
+  template<class O, class Comp, class Proj, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && (!range<Proj>) && __detail::__set_outputtable<O, Rs...[0]> &&
+            __detail::__pairwise_projected_set_order<Comp, Proj, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Proj proj, Rs&&... rs) const {
+    auto current = tuple(ranges::begin(rs)...);
+    auto last = tuple(ranges::end(rs)...);
+    auto& first1 = std::get<0>(current);
+    auto& last1 = std::get<0>(last);
+    if constexpr (sizeof...(Rs) == 2) {
+      auto& first2 = std::get<1>(current);
+      auto& last2 = std::get<1>(last);
+      while (first1 != last1 && first2 != last2) {
+        const weak_ordering order = __detail::__set_compare(comp, std::__invoke(proj, *first1),
+                                                            std::__invoke(proj, *first2));
+        if (order < 0) {
+          *result = *first1;
+          ++first1;
+          ++result;
+        } else {
+          if (order == 0)
+            ++first1;
+          ++first2;
+        }
+      }
+      return ranges::copy(std::move(first1), std::move(last1), std::move(result)).out;
+    } else {
+      for (; first1 != last1; ++first1) {
+        // Each other input holding the key gives up one element, as in set_difference_view.
+        bool found = false;
+        template for (constexpr size_t N : views::iota(1uz, sizeof...(Rs))) {
+          auto& other = std::get<N>(current);
+          __detail::__seek_to(comp, proj, other, std::get<N>(last), std::__invoke(proj, *first1));
+          if (other != std::get<N>(last) &&
+              !__detail::__set_less(comp, std::__invoke(proj, *first1),
+                                    std::__invoke(proj, *other))) {
+            ++other;
+            found = true;
+          }
+        }
+        if (!found) {
+          *result = *first1;
+          ++result;
+        }
+      }
+      return result;
+    }
+  }
+
+  template<class O, class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__set_outputtable<O, Rs...[0]> &&
+            __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Rs&&... rs) const {
+    return (*this)(std::move(result), std::move(comp), identity{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class Comp, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             __detail::__parallel_set_operable<O, R1, R2> &&
+             __detail::__set_outputtable<O, R1> &&
+             __detail::__indirect_set_order<Comp, iterator_t<R1>, iterator_t<R2>>
+  O
+  operator()(Ep&&, O result, Comp comp, R1&& r1, R2&& r2) const {
+    return __detail::__parallel_set_into<Ep>(
+      std::move(result), comp, r1, r2,
+      [&](auto out, auto s1, auto s2) { return (*this)(std::move(out), comp, s1, s2); },
+      [&](auto s1, auto s2) {
+        return __detail::__count_merge<true>(comp, s1, s2).difference_size();
+      });
+  }
+};
+
+inline constexpr SetDifferenceIntoBy set_difference_into_by;
+
+struct SetDifferenceInto {
+  template<class O, input_range... Rs>
+    requires requires(O result, Rs&&... rs) {
+      set_difference_into_by(std::move(result), ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr O
+  operator()(O result, Rs&&... rs) const {
+    return set_difference_into_by(std::move(result), ranges::less{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             requires(Ep&& policy, O result, R1&& r1, R2&& r2) {
+               set_difference_into_by(std::forward<Ep>(policy), std::move(result), ranges::less{},
+                                      std::forward<R1>(r1), std::forward<R2>(r2));
+             }
+  O
+  operator()(Ep&& policy, O result, R1&& r1, R2&& r2) const {
+    return set_difference_into_by(std::forward<Ep>(policy), std::move(result), ranges::less{},
+                                  std::forward<R1>(r1), std::forward<R2>(r2));
+  }
+};
+
+inline constexpr SetDifferenceInto set_difference_into;
+
+// The keys held by an odd number of inputs, or by exactly one, grouped rank by rank as
+// views::set_symmetric_difference_by does; each kept group writes the element of its
+// lowest-numbered input.
+struct SetSymmetricDifferenceIntoBy {
+  template<class O, class Comp, class Proj, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && (!range<Proj>) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_projected_set_order<Comp, Proj, Rs...>
+  constexpr O
+  operator()(O result, set_symmetric_difference_mode mode, Comp comp, Proj proj,
+             Rs&&... rs) const {
+    // Groups from two inputs hold one or two elements, so both modes keep the same ones.
+    if constexpr (sizeof...(Rs) == 2) {
+      auto [first1, first2] = tuple(ranges::begin(rs)...);
+      auto [last1, last2] = tuple(ranges::end(rs)...);
+      while (first1 != last1 && first2 != last2) {
+        const weak_ordering order = __detail::__set_compare(comp, std::__invoke(proj, *first1),
+                                                            std::__invoke(proj, *first2));
+        if (order < 0) {
+          *result = *first1;
+          ++first1;
+          ++result;
+        } else if (order > 0) {
+          *result = *first2;
+          ++first2;
+          ++result;
+        } else {
+          ++first1;
+          ++first2;
+        }
+      }
+      result = ranges::copy(std::move(first1), std::move(last1), std::move(result)).out;
+      return ranges::copy(std::move(first2), std::move(last2), std::move(result)).out;
+    } else
+      return __detail::__merge_groups(comp, proj, std::move(result),
+                                      [mode](size_t group_size) {
+                                        if (mode == set_symmetric_difference_mode::parity)
+                                          return group_size % 2 == 1;
+                                        return group_size == 1;
+                                      },
+                                      rs...);
+  }
+
+  template<class O, class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr O
+  operator()(O result, set_symmetric_difference_mode mode, Comp comp, Rs&&... rs) const {
+    return (*this)(std::move(result), mode, std::move(comp), identity{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class O, class Comp, class Proj, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && (!range<Proj>) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_projected_set_order<Comp, Proj, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Proj proj, Rs&&... rs) const {
+    return (*this)(std::move(result), set_symmetric_difference_mode::parity, std::move(comp),
+                   std::move(proj), std::forward<Rs>(rs)...);
+  }
+
+  template<class O, class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__set_outputtable<O, Rs...> &&
+            __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr O
+  operator()(O result, Comp comp, Rs&&... rs) const {
+    return (*this)(std::move(result), set_symmetric_difference_mode::parity, std::move(comp),
+                   identity{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class Comp, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             __detail::__parallel_set_operable<O, R1, R2> &&
+             __detail::__set_outputtable<O, R1, R2> &&
+             __detail::__indirect_set_order<Comp, iterator_t<R1>, iterator_t<R2>>
+  O
+  operator()(Ep&&, O result, Comp comp, R1&& r1, R2&& r2) const {
+    return __detail::__parallel_set_into<Ep>(
+      std::move(result), comp, r1, r2,
+      [&](auto out, auto s1, auto s2) { return (*this)(std::move(out), comp, s1, s2); },
+      [&](auto s1, auto s2) {
+        return __detail::__count_merge<true>(comp, s1, s2).symmetric_difference_size();
+      });
+  }
+};
+
+inline constexpr SetSymmetricDifferenceIntoBy set_symmetric_difference_into_by;
+
+struct SetSymmetricDifferenceInto {
+  template<class O, input_range... Rs>
+    requires requires(O result, Rs&&... rs) {
+      set_symmetric_difference_into_by(std::move(result), ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr O
+  operator()(O result, Rs&&... rs) const {
+    return set_symmetric_difference_into_by(std::move(result), ranges::less{},
+                                            std::forward<Rs>(rs)...);
+  }
+
+  template<class O, input_range... Rs>
+    requires requires(O result, set_symmetric_difference_mode mode, Rs&&... rs) {
+      set_symmetric_difference_into_by(std::move(result), mode, ranges::less{},
+                                       std::forward<Rs>(rs)...);
+    }
+  constexpr O
+  operator()(O result, set_symmetric_difference_mode mode, Rs&&... rs) const {
+    return set_symmetric_difference_into_by(std::move(result), mode, ranges::less{},
+                                            std::forward<Rs>(rs)...);
+  }
+
+  template<class Ep, class O, class R1, class R2>
+    requires is_execution_policy_v<remove_cvref_t<Ep>> &&
+             requires(Ep&& policy, O result, R1&& r1, R2&& r2) {
+               set_symmetric_difference_into_by(std::forward<Ep>(policy), std::move(result),
+                                                ranges::less{}, std::forward<R1>(r1),
+                                                std::forward<R2>(r2));
+             }
+  O
+  operator()(Ep&& policy, O result, R1&& r1, R2&& r2) const {
+    return set_symmetric_difference_into_by(std::forward<Ep>(policy), std::move(result),
+                                            ranges::less{}, std::forward<R1>(r1),
+                                            std::forward<R2>(r2));
+  }
+};
+
+inline constexpr SetSymmetricDifferenceInto set_symmetric_difference_into;
+
+// Cardinalities of the same operations, computed without materializing a single element.
+
+struct SetIntersectionSizeBy {
+  template<class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr common_type_t<range_difference_t<Rs>...>
+  operator()(Comp comp, Rs&&... rs) const {
+    if constexpr (sizeof...(Rs) == 2)
+      return __detail::__count_merge<false>(std::move(comp), rs...).both;
+    else {
+      auto current = tuple(ranges::begin(rs)...);
+      auto last = tuple(ranges::end(rs)...);
+      common_type_t<range_difference_t<Rs>...> n = 0;
+      identity proj;
+      while (true) {
+        switch (__detail::__align_intersection(comp, proj, current, last)) {
+          case __detail::__align_result::exhausted:
+            return n;
+          case __detail::__align_result::retry:
+            continue;
+          case __detail::__align_result::aligned:
+            break;
+        }
+        ++n;
+        __detail::__tuple_for_each([](auto& i) { ++i; }, current);
+      }
+    }
+  }
+};
+
+inline constexpr SetIntersectionSizeBy set_intersection_size_by;
+
+struct SetIntersectionSize {
+  template<input_range... Rs>
+    requires requires(Rs&&... rs) {
+      set_intersection_size_by(ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr auto
+  operator()(Rs&&... rs) const {
+    return set_intersection_size_by(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetIntersectionSize set_intersection_size;
+
+struct SetUnionSizeBy {
+  template<class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr common_type_t<range_difference_t<Rs>...>
+  operator()(Comp comp, Rs&&... rs) const {
+    if constexpr (sizeof...(Rs) == 2)
+      return __detail::__count_merge<true>(std::move(comp), rs...).union_size();
+    else
+      return set_union_into_by(__detail::__counting_output(), std::move(comp), rs...).count();
+  }
+};
+
+inline constexpr SetUnionSizeBy set_union_size_by;
+
+struct SetUnionSize {
+  template<input_range... Rs>
+    requires requires(Rs&&... rs) { set_union_size_by(ranges::less{}, std::forward<Rs>(rs)...); }
+  constexpr auto
+  operator()(Rs&&... rs) const {
+    return set_union_size_by(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetUnionSize set_union_size;
+
+struct SetDifferenceSizeBy {
+  template<class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr common_type_t<range_difference_t<Rs>...>
+  operator()(Comp comp, Rs&&... rs) const {
+    if constexpr (sizeof...(Rs) == 2)
+      return __detail::__count_merge<true>(std::move(comp), rs...).difference_size();
+    else
+      return set_difference_into_by(__detail::__counting_output(), std::move(comp), rs...).count();
+  }
+};
+
+inline constexpr SetDifferenceSizeBy set_difference_size_by;
+
+struct SetDifferenceSize {
+  template<input_range... Rs>
+    requires requires(Rs&&... rs) {
+      set_difference_size_by(ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr auto
+  operator()(Rs&&... rs) const {
+    return set_difference_size_by(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetDifferenceSize set_difference_size;
+
+struct SetSymmetricDifferenceSizeBy {
+  template<class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr common_type_t<range_difference_t<Rs>...>
+  operator()(set_symmetric_difference_mode mode, Comp comp, Rs&&... rs) const {
+    if constexpr (sizeof...(Rs) == 2)
+      return __detail::__count_merge<true>(std::move(comp), rs...).symmetric_difference_size();
+    else
+      return set_symmetric_difference_into_by(__detail::__counting_output(), mode,
+                                              std::move(comp), rs...)
+        .count();
+  }
+
+  template<class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr common_type_t<range_difference_t<Rs>...>
+  operator()(Comp comp, Rs&&... rs) const {
+    return (*this)(set_symmetric_difference_mode::parity, std::move(comp), rs...);
+  }
+};
+
+inline constexpr SetSymmetricDifferenceSizeBy set_symmetric_difference_size_by;
+
+struct SetSymmetricDifferenceSize {
+  template<input_range... Rs>
+    requires requires(Rs&&... rs) {
+      set_symmetric_difference_size_by(ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr auto
+  operator()(Rs&&... rs) const {
+    return set_symmetric_difference_size_by(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+
+  template<input_range... Rs>
+    requires requires(set_symmetric_difference_mode mode, Rs&&... rs) {
+      set_symmetric_difference_size_by(mode, ranges::less{}, std::forward<Rs>(rs)...);
+    }
+  constexpr auto
+  operator()(set_symmetric_difference_mode mode, Rs&&... rs) const {
+    return set_symmetric_difference_size_by(mode, ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetSymmetricDifferenceSize set_symmetric_difference_size;
+
+// Early-exit predicates over the same inputs: each stops at its first witness.
+
+struct SetIntersectsBy {
+  template<class Comp, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && __detail::__pairwise_indirect_set_order<Comp, Rs...>
+  constexpr bool
+  operator()(Comp comp, Rs&&... rs) const {
+    auto current = tuple(ranges::begin(rs)...);
+    auto last = tuple(ranges::end(rs)...);
+    identity proj;
+    while (true) {
+      switch (__detail::__align_intersection(comp, proj, current, last)) {
+        case __detail::__align_result::exhausted:
+          return false;
+        case __detail::__align_result::retry:
+          continue;
+        case __detail::__align_result::aligned:
+          return true;
+      }
+    }
+  }
+};
+
+inline constexpr SetIntersectsBy set_intersects_by;
+
+struct SetIntersects {
+  template<input_range... Rs>
+    requires requires(Rs&&... rs) { set_intersects_by(ranges::less{}, std::forward<Rs>(rs)...); }
+  constexpr bool
+  operator()(Rs&&... rs) const {
+    return set_intersects_by(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetIntersects set_intersects;
+
+struct SetDisjointBy {
+  template<class Comp, input_range... Rs>
+    requires requires(Comp comp, Rs&&... rs) {
+      set_intersects_by(std::move(comp), std::forward<Rs>(rs)...);
+    }
+  constexpr bool
+  operator()(Comp comp, Rs&&... rs) const {
+    return !set_intersects_by(std::move(comp), std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetDisjointBy set_disjoint_by;
+
+struct SetDisjoint {
+  template<input_range... Rs>
+    requires requires(Rs&&... rs) { set_intersects_by(ranges::less{}, std::forward<Rs>(rs)...); }
+  constexpr bool
+  operator()(Rs&&... rs) const {
+    return !set_intersects_by(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetDisjoint set_disjoint;
+
+// Whether r includes each of rs. With more than one subset r is walked once per subset, so it
+// must then be a forward range.
+struct SetIncludesBy {
+  template<class Comp, input_range R, input_range... Rs>
+    requires(sizeof...(Rs) > 0) && (sizeof...(Rs) == 1 || forward_range<R>) &&
+            __detail::__pairwise_indirect_set_order<Comp, R, Rs...>
+  constexpr bool
+  operator()(Comp comp, R&& r, Rs&&... rs) const {
+    auto includes = [&](auto& sub) {
+      if constexpr (sized_range<R> && sized_range<decltype(sub)>)
+        if (ranges::distance(sub) > ranges::distance(r))
+          return false;
+      return __detail::__includes(comp, ranges::begin(r), ranges::end(r), sub);
+    };
+    return (includes(rs) && ...);
+  }
+};
+
+inline constexpr SetIncludesBy set_includes_by;
+
+struct SetIncludes {
+  template<input_range R, input_range... Rs>
+    requires requires(R&& r, Rs&&... rs) {
+      set_includes_by(ranges::less{}, std::forward<R>(r), std::forward<Rs>(rs)...);
+    }
+  constexpr bool
+  operator()(R&& r, Rs&&... rs) const {
+    return set_includes_by(ranges::less{}, std::forward<R>(r), std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetIncludes set_includes;
+
+}  // namespace std::ranges
@@ -0,0 +1,427 @@
+#pragma once
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <ranges>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace std::ranges::__detail {
+
+template<class T>
+concept __simd_set_element = unsigned_integral<T> && (sizeof(T) == 4 || sizeof(T) == 8);
+
+// Pairs of ranges under ranges::less whose elements can be merged as raw machine words.
+template<class R1, class R2>
+concept __simd_set_operable = contiguous_range<R1> && contiguous_range<R2> &&
+  sized_sentinel_for<sentinel_t<R1>, iterator_t<R1>> &&
+  sized_sentinel_for<sentinel_t<R2>, iterator_t<R2>> &&
+  same_as<range_value_t<R1>, range_value_t<R2>> && __simd_set_element<range_value_t<R1>>;
+
+// Comparators under which the kernels' unsigned comparisons give the same order.
+template<class Comp>
+concept __simd_set_comparator = same_as<Comp, ranges::less> || same_as<Comp, compare_three_way>;
+
+// Which elements of the first input a block kernel reports: those found in the second input,
+// or those missing from it.
+enum class __set_kernel_op { intersection, difference };
+
+// A kernel merges [a, a_end) with [b, b_end), writes at most `cap` positions of results in the
+// first input to `out`, advances `a` and `b` past everything it has consumed and returns the
+// number of positions written. Zero means there are no results left.
+template<class T>
+using __set_kernel_t = size_t (*)(const T*&, const T*, const T*&, const T*, const T**, size_t);
+
+template<__set_kernel_op Op, class T>
+constexpr size_t
+__set_scalar(const T*& a, const T* a_end, const T*& b, const T* b_end, const T** out,
+             size_t cap) {
+  size_t n = 0;
+  while (a != a_end && n != cap) {
+    if (b == b_end) {
+      if constexpr (Op == __set_kernel_op::intersection)
+        break;
+      else {
+        out[n++] = a++;
+        continue;
+      }
+    }
+    const T x = *a;
+    const T y = *b;
+    out[n] = a;
+    if constexpr (Op == __set_kernel_op::intersection)
+      n += x == y;
+    else
+      n += x < y;
+    a += !(y < x);
+    b += !(x < y);
+  }
+  return n;
+}
+
+// Counts the elements the two inputs have in common, pairing equal elements rank by rank.
+template<class T>
+constexpr size_t
+__count_scalar(const T*& a, const T* a_end, const T*& b, const T* b_end) {
+  size_t n = 0;
+  while (a != a_end && b != b_end) {
+    const T x = *a;
+    const T y = *b;
+    n += x == y;
+    a += !(y < x);
+    b += !(x < y);
+  }
+  return n;
+}
+
+// Finishes a block of w strictly increasing elements of the first input against fewer than a
+// block's worth of the second, returning the lanes found there.
+template<class T>
+constexpr unsigned
+__probe_tail(const T* a, ptrdiff_t w, const T*& b, const T* b_end) {
+  unsigned mask = 0;
+  for (ptrdiff_t i = 0; i < w; ++i) {
+    while (b != b_end && *b < a[i])
+      ++b;
+    if (b == b_end)
+      break;
+    if (*b == a[i])
+      mask |= 1u << i;
+  }
+  return mask;
+}
+
+template<__set_kernel_op Op, class T>
+constexpr size_t
+__emit_lanes(const T* a, ptrdiff_t w, unsigned mask, const T** out) {
+  if constexpr (Op == __set_kernel_op::difference)
+    mask = ~mask & ((1u << w) - 1);
+  size_t n = 0;
+  for (; mask != 0; mask &= mask - 1)
+    out[n++] = a + std::countr_zero(mask);
+  return n;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The vector loops below compare a block of W elements of the first input against successive
+// blocks of the second with an all-pairs equality test, OR-ing the hits into a lane mask until
+// the second input's block overtakes the first's. The all-pairs test cannot tell one match from
+// two, so a block of the first input that is not strictly increasing (one more element included,
+// to cover the seam with the next block) is merged by the scalar loop instead; duplicates in the
+// second input are harmless because each lane of the first is decided exactly once.
+
+template<class T>
+[[gnu::target("sse4.2"), gnu::always_inline]] inline unsigned
+__lane_eq_sse42(__m128i x, __m128i y) {
+  if constexpr (sizeof(T) == 4)
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, y)));
+  else
+    return _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(x, y)));
+}
+
+template<class T>
+[[gnu::target("sse4.2"), gnu::always_inline]] inline unsigned
+__match_sse42(__m128i va, __m128i vb) {
+  if constexpr (sizeof(T) == 4) {
+    __m128i eq = _mm_cmpeq_epi32(va, vb);
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+    return _mm_movemask_ps(_mm_castsi128_ps(eq));
+  } else {
+    __m128i eq = _mm_cmpeq_epi64(va, vb);
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi64(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+    return _mm_movemask_pd(_mm_castsi128_pd(eq));
+  }
+}
+
+template<__set_kernel_op Op, class T>
+[[gnu::target("sse4.2")]] size_t
+__set_sse42(const T*& a, const T* a_end, const T*& b, const T* b_end, const T** out,
+            size_t cap) {
+  constexpr ptrdiff_t W = 16 / sizeof(T);
+  size_t n = 0;
+  while (a_end - a > W && b_end - b >= W && cap - n >= W) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    if (__lane_eq_sse42<T>(va, _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 1)))) {
+      n += __set_scalar<Op>(a, a + W, b, b_end, out + n, cap - n);
+      continue;
+    }
+    unsigned mask = 0;
+    while (true) {
+      if (b_end - b < W) {
+        mask |= __probe_tail(a, W, b, b_end);
+        break;
+      }
+      mask |= __match_sse42<T>(va, _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+      const T a_max = a[W - 1];
+      const T b_max = b[W - 1];
+      if (!(a_max < b_max))
+        b += W;
+      if (!(b_max < a_max))
+        break;
+    }
+    n += __emit_lanes<Op>(a, W, mask, out + n);
+    a += W;
+  }
+  return n + __set_scalar<Op>(a, a_end, b, b_end, out + n, cap - n);
+}
+
+template<class T>
+[[gnu::target("sse4.2")]] size_t
+__count_sse42(const T* a, const T* a_end, const T* b, const T* b_end) {
+  constexpr ptrdiff_t W = 16 / sizeof(T);
+  size_t n = 0;
+  while (a_end - a > W && b_end - b >= W) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    if (__lane_eq_sse42<T>(va, _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 1)))) {
+      n += __count_scalar(a, a + W, b, b_end);
+      continue;
+    }
+    unsigned mask = 0;
+    while (true) {
+      if (b_end - b < W) {
+        mask |= __probe_tail(a, W, b, b_end);
+        break;
+      }
+      mask |= __match_sse42<T>(va, _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+      const T a_max = a[W - 1];
+      const T b_max = b[W - 1];
+      if (!(a_max < b_max))
+        b += W;
+      if (!(b_max < a_max))
+        break;
+    }
+    n += std::popcount(mask);
+    a += W;
+  }
+  return n + __count_scalar(a, a_end, b, b_end);
+}
+
+template<class T>
+[[gnu::target("avx2"), gnu::always_inline]] inline unsigned
+__lane_eq_avx2(__m256i x, __m256i y) {
+  if constexpr (sizeof(T) == 4)
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+  else
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, y)));
+}
+
+template<class T>
+[[gnu::target("avx2"), gnu::always_inline]] inline unsigned
+__match_avx2(__m256i va, __m256i vb) {
+  if constexpr (sizeof(T) == 4) {
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    __m256i eq = _mm256_cmpeq_epi32(va, vb);
+    for (int i = 1; i < 8; ++i) {
+      vb = _mm256_permutevar8x32_epi32(vb, rotate);
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+    }
+    return _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+  } else {
+    __m256i eq = _mm256_cmpeq_epi64(va, vb);
+    for (int i = 1; i < 4; ++i) {
+      vb = _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1));
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi64(va, vb));
+    }
+    return _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+  }
+}
+
+template<__set_kernel_op Op, class T>
+[[gnu::target("avx2")]] size_t
+__set_avx2(const T*& a, const T* a_end, const T*& b, const T* b_end, const T** out,
+           size_t cap) {
+  constexpr ptrdiff_t W = 32 / sizeof(T);
+  size_t n = 0;
+  while (a_end - a > W && b_end - b >= W && cap - n >= W) {
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    if (__lane_eq_avx2<T>(va, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 1)))) {
+      n += __set_scalar<Op>(a, a + W, b, b_end, out + n, cap - n);
+      continue;
+    }
+    unsigned mask = 0;
+    while (true) {
+      if (b_end - b < W) {
+        mask |= __probe_tail(a, W, b, b_end);
+        break;
+      }
+      mask |= __match_avx2<T>(va, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+      const T a_max = a[W - 1];
+      const T b_max = b[W - 1];
+      if (!(a_max < b_max))
+        b += W;
+      if (!(b_max < a_max))
+        break;
+    }
+    n += __emit_lanes<Op>(a, W, mask, out + n);
+    a += W;
+  }
+  return n + __set_scalar<Op>(a, a_end, b, b_end, out + n, cap - n);
+}
+template<class T>
+[[gnu::target("avx2")]] size_t
+__count_avx2(const T* a, const T* a_end, const T* b, const T* b_end) {
+  constexpr ptrdiff_t W = 32 / sizeof(T);
+  size_t n = 0;
+  while (a_end - a > W && b_end - b >= W) {
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    if (__lane_eq_avx2<T>(va, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + 1)))) {
+      n += __count_scalar(a, a + W, b, b_end);
+      continue;
+    }
+    unsigned mask = 0;
+    while (true) {
+      if (b_end - b < W) {
+        mask |= __probe_tail(a, W, b, b_end);
+        break;
+      }
+      mask |= __match_avx2<T>(va, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+      const T a_max = a[W - 1];
+      const T b_max = b[W - 1];
+      if (!(a_max < b_max))
+        b += W;
+      if (!(b_max < a_max))
+        break;
+    }
+    n += std::popcount(mask);
+    a += W;
+  }
+  return n + __count_scalar(a, a_end, b, b_end);
+}
+#endif
+
+template<__set_kernel_op Op, class T>
+__set_kernel_t<T>
+__select_set_kernel() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return &__set_avx2<Op, T>;
+  if (__builtin_cpu_supports("sse4.2"))
+    return &__set_sse42<Op, T>;
+#endif
+  return &__set_scalar<Op, T>;
+}
+
+// Runs the widest kernel the CPU supports; constant evaluation takes the scalar one.
+template<__set_kernel_op Op, class T>
+constexpr size_t
+__set_block(const T*& a, const T* a_end, const T*& b, const T* b_end, const T** out,
+            size_t cap) {
+  if consteval {
+    return __set_scalar<Op>(a, a_end, b, b_end, out, cap);
+  } else {
+    static const __set_kernel_t<T> kernel = __select_set_kernel<Op, T>();
+    return kernel(a, a_end, b, b_end, out, cap);
+  }
+}
+
+template<class T>
+using __count_kernel_t = size_t (*)(const T*, const T*, const T*, const T*);
+
+template<class T>
+__count_kernel_t<T>
+__select_count_kernel() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return &__count_avx2<T>;
+  if (__builtin_cpu_supports("sse4.2"))
+    return &__count_sse42<T>;
+#endif
+  return [](const T* a, const T* a_end, const T* b, const T* b_end) {
+    return __count_scalar(a, a_end, b, b_end);
+  };
+}
+
+// Counts the common elements of [a, a_end) and [b, b_end) with the widest kernel the CPU
+// supports, popcounting the vector loops' lane masks instead of emitting positions.
+template<class T>
+constexpr size_t
+__set_count(const T* a, const T* a_end, const T* b, const T* b_end) {
+  if consteval {
+    return __count_scalar(a, a_end, b, b_end);
+  } else {
+    static const __count_kernel_t<T> kernel = __select_count_kernel<T>();
+    return kernel(a, a_end, b, b_end);
+  }
+}
+
+// Results produced by a block kernel but not yet handed out by an iterator, as positions in the
+// first input, and the position in the first input from which the kernel resumes.
+template<class T>
+struct __set_block_buffer {
+  static constexpr size_t capacity_ = 16;
+  const T* items_[capacity_]{};
+  const T* next1_ = nullptr;
+  unsigned char pos_ = 0;
+  unsigned char size_ = 0;
+
+  template<contiguous_iterator I>
+  constexpr void
+  start(const I& current1) {
+    next1_ = std::to_address(current1);
+    pos_ = size_ = 0;
+  }
+
+  // Moves current1 onto the next result, running the kernel when the buffer has been drained.
+  // current2 follows the kernel's progress through the second input; once there are no results
+  // left, current1 is moved to end1.
+  template<__set_kernel_op Op, class I1, class S1, class I2, class S2>
+  constexpr void
+  satisfy(I1& current1, const S1& end1, I2& current2, const S2& end2) {
+    if (pos_ == size_) {
+      const T* a = next1_;
+      const T* a_end = std::to_address(current1) + (end1 - current1);
+      const T* b = std::to_address(current2);
+      const T* b_end = b + (end2 - current2);
+      size_ = __set_block<Op>(a, a_end, b, b_end, items_, capacity_);
+      pos_ = 0;
+      next1_ = a;
+      current2 += b - std::to_address(current2);
+      if (size_ == 0) {
+        current1 += a_end - std::to_address(current1);
+        return;
+      }
+    }
+    current1 += items_[pos_] - std::to_address(current1);
+  }
+
+  constexpr void
+  pop() noexcept {
+    ++pos_;
+  }
+
+  // Leaves current1 as the only buffered result, for an iterator that has stepped back onto it;
+  // the kernel resumes just past it once it is popped.
+  template<contiguous_iterator I>
+  constexpr void
+  hold(const I& current1) {
+    items_[0] = std::to_address(current1);
+    next1_ = items_[0] + 1;
+    pos_ = 0;
+    size_ = 1;
+  }
+
+  // Drops the buffered results less than key and moves current1 onto the first one left. With
+  // none left, current1 is moved to where the kernel resumes and false is returned; the cursors
+  // then stand where a merge would have left them, so both may skip ahead from there.
+  template<contiguous_iterator I, class Key>
+  constexpr bool
+  skip(I& current1, const Key& key) {
+    while (pos_ != size_ && *items_[pos_] < key)
+      ++pos_;
+    if (pos_ != size_) {
+      current1 += items_[pos_] - std::to_address(current1);
+      return true;
+    }
+    current1 += next1_ - std::to_address(current1);
+    return false;
+  }
+};
+
+}  // namespace std::ranges::__detail
@@ -1,79 +1,210 @@
 #include <ranges>
 
+#include "concepts.h"
+#include "merge_tree.h"
+#include "roaring.hpp"
+
 namespace std::ranges {
-template<class Comp, input_range V1, input_range V2>
-  requires view<V1> && view<V2> && is_object_v<Comp> && is_object_v<Comp> &&
-  indirect_strict_weak_order<Comp, iterator_t<V1>, iterator_t<V2>> && __detail::__concatable<V1, V2>
+// Which keys a K-way symmetric difference keeps. Equal elements are grouped rank by rank across
+// the inputs, so a key held m times by one input and n times by another forms max(m, n) groups.
+// Over sets, parity agrees with chained binary symmetric differences; over multisets it need not:
+// {1, 1}, {1} and {1} keep both 1s here, where the chain cancels them all.
+enum class set_symmetric_difference_mode {
+  parity,       // groups drawn from an odd number of inputs
+  exactly_one,  // groups drawn from a single input
+};
+
+template<class Comp, class Proj, input_range... Views>
+  requires(view<Views> && ...) && (sizeof...(Views) > 0) && is_object_v<Comp> &&
+  is_object_v<Proj> && __detail::__pairwise_projected_set_order<Comp, Proj, Views...> &&
+  __detail::__concatable<Views...>
 class set_symmetric_difference_view
-  : public view_interface<set_symmetric_difference_view<Comp, V1, V2>> {
-  V1 base1_ = V1();             // exposition only
-  V2 base2_ = V2();             // exposition only
-  __detail::__box<Comp> comp_;  // exposition only
+  : public view_interface<set_symmetric_difference_view<Comp, Proj, Views...>> {
+  [[no_unique_address]] __detail::__box<Comp> comp_;  // exposition only
+  [[no_unique_address]] __detail::__box<Proj> proj_;  // exposition only
+  [[no_unique_address]] tuple<Views...> views_;       // exposition only
+  set_symmetric_difference_mode mode_ = set_symmetric_difference_mode::parity;  // exposition only
 
   // [range.set.symmetric.difference.iterator], class set_symmetric_difference_view::iterator
   class iterator {
     friend set_symmetric_difference_view;
 
-    iterator_t<V1> current1_ = iterator_t<V1>();  // exposition only
-    iterator_t<V2> current2_ = iterator_t<V2>();  // exposition only
+    using merged_reference = __detail::__concat_reference_t<Views...>;  // exposition only
+    using merged_key =
+      common_reference_t<__detail::__key_reference_t<Proj, iterator_t<Views>>...>;
+
+    // As in set_union_view, many inputs are ordered by a tournament tree, which also collects
+    // each group of equal keys.
+    static constexpr bool use_tree = sizeof...(Views) > __detail::__merge_tree_threshold &&
+      is_reference_v<merged_key> && __detail::__set_order<Comp&, merged_key>;
+
+    tuple<iterator_t<Views>...> current_;  // exposition only
+    tuple<sentinel_t<Views>...> end_;      // exposition only
+    [[no_unique_address]] tuple<
+      __detail::__key_cache<Proj, iterator_t<Views>>...> keys_;  // exposition only
     set_symmetric_difference_view* parent_ = nullptr;
-    bool use_first_ = false;  // exposition only
+    // The lowest-numbered input of the current group, whose element is the one yielded.
+    size_t active_idx_ = -1;  // exposition only
+    [[no_unique_address]] __detail::__maybe_present_t<
+      use_tree, __detail::__tournament_tree<sizeof...(Views)>> tree_;  // exposition only
 
+    template<size_t N>
+    constexpr void
+    refresh() {  // exposition only
+      std::get<N>(keys_).refresh(*parent_->proj_, std::get<N>(current_), std::get<N>(end_));
+    }
+
+    template<size_t N>
+    constexpr decltype(auto)
+    key() const {  // exposition only
+      return std::get<N>(keys_).get(std::get<N>(current_));
+    }
+
+    constexpr bool
+    at_end(size_t i) const {  // exposition only
+      return __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+        return std::get<N>(current_) == std::get<N>(end_);
+      });
+    }
+
+    constexpr merged_key
+    key_at(size_t i) const {  // exposition only
+      return __detail::__visit_index<sizeof...(Views)>(
+        i, [&]<size_t N> -> merged_key { return key<N>(); });
+    }
+
+    constexpr bool
+    ahead(size_t i, size_t j) const {  // exposition only
+      if (at_end(j))
+        return !at_end(i) || i < j;
+      if (at_end(i))
+        return false;
+      const weak_ordering order = __detail::__set_compare(*parent_->comp_, key_at(i), key_at(j));
+      return order < 0 || (order == 0 && i < j);
+    }
+
+    template<class F>
+    constexpr decltype(auto)
+    visit_active(F&& f) const {  // exposition only
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        if (N == active_idx_)
+          return std::forward<F>(f).template operator()<N>();
+      }
+      unreachable();
+    }
+
+    constexpr bool
+    emits(size_t group_size) const noexcept {  // exposition only
+      if (parent_->mode_ == set_symmetric_difference_mode::parity)
+        return group_size % 2 == 1;
+      return group_size == 1;
+    }
+
+    // Steps every cursor of the current group past its element.
+    constexpr void
+    advance_group() {  // exposition only
+      if constexpr (use_tree)
+        tree_.release([this](size_t i, size_t j) { return ahead(i, j); },
+                      [this](size_t i) {
+                        __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+                          ++std::get<N>(current_);
+                          refresh<N>();
+                        });
+                      });
+      else
+        visit_active([&]<size_t ActiveIdx> {
+          template for (constexpr size_t N : views::iota(ActiveIdx + 1, sizeof...(Views))) {
+            auto& other = std::get<N>(current_);
+            if (other != std::get<N>(end_) &&
+                !__detail::__set_less(*parent_->comp_, key<ActiveIdx>(), key<N>())) {
+              ++other;
+              refresh<N>();
+            }
+          }
+          ++std::get<ActiveIdx>(current_);
+          refresh<ActiveIdx>();
+        });
+    }
+
+    // Finds the group of least keys and its size, skipping groups the mode does not keep.
     constexpr void
     satisfy() {  // exposition only
       while (true) {
-        if (current1_ == ranges::end(parent_->base1_)) {
-          use_first_ = false;
-          return;
-        }
-        if (current2_ == ranges::end(parent_->base2_)) {
-          use_first_ = true;
-          return;
-        }
-        if (std::__invoke(*parent_->comp_, *current1_, *current2_)) {
-          use_first_ = true;
-          return;
+        size_t group_size = 0;
+        if constexpr (use_tree) {
+          active_idx_ = tree_.top();
+          if (at_end(active_idx_)) {
+            active_idx_ = -1;
+            return;
+          }
+          tree_.gather([this](size_t i, size_t j) { return ahead(i, j); },
+                       [this](size_t i) {
+                         return !at_end(i) &&
+                           !__detail::__set_less(*parent_->comp_, key_at(active_idx_), key_at(i));
+                       });
+          group_size = tree_.group().size();
+        } else {
+          active_idx_ = -1;
+          template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+            if (std::get<N>(current_) == std::get<N>(end_))
+              continue;
+            if (active_idx_ == -1) {
+              active_idx_ = N;
+              group_size = 1;
+              continue;
+            }
+            const weak_ordering order = visit_active([&]<size_t ActiveIdx> {
+              return __detail::__set_compare(*parent_->comp_, key<N>(), key<ActiveIdx>());
+            });
+            if (order < 0) {
+              active_idx_ = N;
+              group_size = 1;
+            } else if (order == 0)
+              ++group_size;
+          }
+          if (active_idx_ == -1)
+            return;
         }
-        if (std::__invoke(*parent_->comp_, *current2_, *current1_)) {
-          use_first_ = false;
+        if (emits(group_size))
           return;
-        }
-        ++current1_;
-        ++current2_;
+        advance_group();
       }
     }
 
-    constexpr iterator(set_symmetric_difference_view* parent,
-                       iterator_t<V1> current1,  // exposition only
-                       iterator_t<V2> current2)
-      : parent_(parent), current1_(std::move(current1)), current2_(std::move(current2)) {
+    constexpr explicit iterator(set_symmetric_difference_view* parent,
+                                tuple<iterator_t<Views>...> current)
+      : parent_(parent),
+        current_(std::move(current)),
+        end_(__detail::__tuple_transform(ranges::end, parent->views_)) {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
+      if constexpr (use_tree)
+        tree_.build([this](size_t i, size_t j) { return ahead(i, j); });
       satisfy();
     }
 
    public:
     // using iterator_category = see below;  // not always present
-    using iterator_concept = conditional_t<forward_range<V1> && forward_range<V2>,
-                                           forward_iterator_tag, input_iterator_tag>;
-    using value_type = __detail::__concat_value_t<V1, V2>;
-    using difference_type = common_type_t<range_difference_t<V1>, range_difference_t<V2>>;
+    // Forward only; the two-input view in set_algo.hpp steps back over bidirectional common inputs.
+    using iterator_concept =
+      conditional_t<(forward_range<Views> && ...), forward_iterator_tag, input_iterator_tag>;
+    using value_type = __detail::__concat_value_t<Views...>;
+    using difference_type = common_type_t<range_difference_t<Views>...>;
 
     iterator()
-      requires default_initializable<iterator_t<V1>> && default_initializable<iterator_t<V2>>
+      requires(default_initializable<iterator_t<Views>> && ...)
     = default;
 
-    constexpr __detail::__concat_reference_t<V1, V2>
+    constexpr merged_reference
     operator*() const {
-      if (use_first_)
-        return *current1_;
-      return *current2_;
+      return visit_active(
+        [&]<size_t ActiveIdx> -> merged_reference { return *std::get<ActiveIdx>(current_); });
     }
 
     constexpr iterator&
     operator++() {
-      if (use_first_)
-        ++current1_;
-      else
-        ++current2_;
+      advance_group();
       satisfy();
       return *this;
     }
@@ -85,92 +216,181 @@ class set_symmetric_difference_view
 
     constexpr iterator
     operator++(int)
-      requires forward_range<V1> && forward_range<V2>
+      requires(forward_range<Views> && ...)
     {
       auto tmp = *this;
       ++*this;
       return tmp;
     }
 
+    // Moves to the first element whose key is not less than target, skipping ahead in every input
+    // rather than stepping through the elements in between.
+    template<class Key>
+      requires(__detail::__set_order<Comp&, __detail::__key_reference_t<Proj, iterator_t<Views>>,
+                                     const Key&> &&
+               ...)
+    constexpr void
+    seek(const Key& target) {
+      if (active_idx_ == -1 || !__detail::__set_less(*parent_->comp_, key_at(active_idx_), target))
+        return;
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      }
+      if constexpr (use_tree)
+        tree_.reset([this](size_t i, size_t j) { return ahead(i, j); });
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
-      requires equality_comparable<iterator_t<V1>> && equality_comparable<iterator_t<V2>>
+      requires(equality_comparable<iterator_t<Views>> && ...)
     {
-      return x.current1_ == y.current1_ && x.current2_ == y.current2_;
+      return x.current_ == y.current_ && x.active_idx_ == y.active_idx_;
     }
 
     friend constexpr bool
     operator==(const iterator& x, default_sentinel_t) {
-      return x.current1_ == ranges::end(x.parent_->base1_) &&
-        x.current2_ == ranges::end(x.parent_->base2_);
+      return x.active_idx_ == -1;
     }
 
-    friend constexpr __detail::__concat_rvalue_reference_t<V1, V2>
-    iter_move(const iterator& i) noexcept(
-      noexcept(ranges::iter_move(i.current1_)) && noexcept(ranges::iter_move(i.current2_)) &&
-      is_nothrow_convertible_v<range_rvalue_reference_t<V1>,
-                               __detail::__concat_rvalue_reference_t<V1, V2>> &&
-      is_nothrow_convertible_v<range_rvalue_reference_t<V2>,
-                               __detail::__concat_rvalue_reference_t<V1, V2>>) {
-      if (i.use_first_)
-        return ranges::iter_move(i.current1_);
-      return ranges::iter_move(i.current2_);
+    friend constexpr __detail::__concat_rvalue_reference_t<Views...>
+    iter_move(const iterator& i) {
+      return i.visit_active(
+        [&]<size_t ActiveIdx> -> __detail::__concat_rvalue_reference_t<Views...> {
+          return ranges::iter_move(std::get<ActiveIdx>(i.current_));
+        });
     }
   };  // exposition only
 
+  static constexpr bool caches_begin = (forward_range<Views> && ...);
+  [[no_unique_address]] __detail::__maybe_present_t<
+    caches_begin, __detail::__non_propagating_cache<iterator>> begin_;  // exposition only
+
  public:
-  set_symmetric_difference_view()
-    requires default_initializable<V1> && default_initializable<V2>
-  = default;
-
-  constexpr explicit set_symmetric_difference_view(Comp comp, V1 base1, V2 base2)
-    : comp_(std::move(comp)), base1_(std::move(base1)), base2_(std::move(base2)) {
-    // __glibcxx_assert(ranges::is_sorted(base1_));
-    // __glibcxx_assert(ranges::is_sorted(base2_));
+  set_symmetric_difference_view() = default;
+
+  constexpr explicit set_symmetric_difference_view(Comp comp, Views... bases)
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...) { }
+
+  constexpr explicit set_symmetric_difference_view(Comp comp, Proj proj, Views... bases)
+    : comp_(std::move(comp)), proj_(std::move(proj)), views_(std::move(bases)...) {
+    // __glibcxx_assert((ranges::is_sorted(bases, *comp_, *proj_) && ...));
+  }
+
+  constexpr explicit set_symmetric_difference_view(set_symmetric_difference_mode mode, Comp comp,
+                                                   Views... bases)
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...), mode_(mode) { }
+
+  constexpr explicit set_symmetric_difference_view(set_symmetric_difference_mode mode, Comp comp,
+                                                   Proj proj, Views... bases)
+    : comp_(std::move(comp)), proj_(std::move(proj)), views_(std::move(bases)...), mode_(mode) { }
+
+  constexpr set_symmetric_difference_mode
+  mode() const noexcept {
+    return mode_;
   }
 
   constexpr iterator
   begin() {
-    return iterator(this, ranges::begin(base1_), ranges::begin(base2_));
+    if constexpr (caches_begin) {
+      if (!begin_._M_has_value())
+        begin_._M_emplace(iterator(this, __detail::__tuple_transform(ranges::begin, views_)));
+      return *begin_;
+    } else
+      return iterator(this, __detail::__tuple_transform(ranges::begin, views_));
   }
 
   constexpr default_sentinel_t
   end() const noexcept {
     return default_sentinel;
   }
+
+  // No more elements than all inputs together.
+  constexpr auto
+  reserve_hint()
+    requires(approximately_sized_range<Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return (CT(hints) + ...);
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires(approximately_sized_range<const Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return (CT(hints) + ...);
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
 };
 
-template<class Comp, class R1, class R2>
-set_symmetric_difference_view(Comp, R1&&, R2&&)
-  -> set_symmetric_difference_view<Comp, views::all_t<R1>, views::all_t<R2>>;
+template<class Comp, class... Rs>
+  requires(!same_as<Comp, set_symmetric_difference_mode>)
+set_symmetric_difference_view(Comp, Rs&&...)
+  -> set_symmetric_difference_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!same_as<Comp, set_symmetric_difference_mode>) && (!range<Proj>)
+set_symmetric_difference_view(Comp, Proj, Rs&&...)
+  -> set_symmetric_difference_view<Comp, Proj, views::all_t<Rs>...>;
+
+template<class Comp, class... Rs>
+set_symmetric_difference_view(set_symmetric_difference_mode, Comp, Rs&&...)
+  -> set_symmetric_difference_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!range<Proj>)
+set_symmetric_difference_view(set_symmetric_difference_mode, Comp, Proj, Rs&&...)
+  -> set_symmetric_difference_view<Comp, Proj, views::all_t<Rs>...>;
 
 namespace views {
 namespace __detail {
-template<class Comp, class R1, class R2>
-concept __can_set_symmetric_difference_view_view = requires {
-  set_symmetric_difference_view(std::declval<Comp>(), std::declval<R1>(), std::declval<R2>());
-};
+template<class... Args>
+concept __can_set_symmetric_difference_view =
+  requires { set_symmetric_difference_view(std::declval<Args>()...); };
 }  // namespace __detail
 
+// set_symmetric_difference_by([mode,] comp, [proj,] rs...)
 struct SetSymmetricDifferenceBy {
-  template<class Comp, class R1, class R2>
-    requires __detail::__can_set_symmetric_difference_view_view<Comp, R1, R2>
+  template<class... Args>
+    requires __detail::__can_set_symmetric_difference_view<Args...>
   constexpr auto
-  operator() [[nodiscard]] (Comp&& comp, R1&& r1, R2&& r2) const {
-    return set_symmetric_difference_view(std::forward<Comp>(comp), std::forward<R1>(r1),
-                                         std::forward<R2>(r2));
+  operator() [[nodiscard]] (Args&&... args) const {
+    return set_symmetric_difference_view(std::forward<Args>(args)...);
   }
 };
 
 inline constexpr SetSymmetricDifferenceBy set_symmetric_difference_by;
 
+// set_symmetric_difference([mode,] rs...)
 struct SetSymmetricDifference {
-  template<class R1, class R2>
-    requires __detail::__can_set_symmetric_difference_view_view<ranges::less, R1, R2>
+  template<class... Rs>
+    requires __detail::__can_set_symmetric_difference_view<ranges::less, Rs...>
+  constexpr auto
+  operator() [[nodiscard]] (Rs&&... rs) const {
+    if constexpr ((ranges::__detail::__roaring_operand<Rs> && ...))
+      return roaring_combine_view(bit_xor<>{}, std::forward<Rs>(rs)...);
+    else
+      return set_symmetric_difference_view(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+
+  template<class... Rs>
+    requires __detail::__can_set_symmetric_difference_view<set_symmetric_difference_mode,
+                                                            ranges::less, Rs...>
   constexpr auto
-  operator() [[nodiscard]] (R1&& r1, R2&& r2) const {
-    return set_symmetric_difference_view(ranges::less{}, std::forward<R1>(r1),
-                                         std::forward<R2>(r2));
+  operator() [[nodiscard]] (set_symmetric_difference_mode mode, Rs&&... rs) const {
+    return set_symmetric_difference_view(mode, ranges::less{}, std::forward<Rs>(rs)...);
   }
 };
 
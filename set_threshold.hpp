@@ -0,0 +1,353 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <ranges>
+
+#include "concepts.h"
+#include "merge_tree.h"
+
+namespace std::ranges {
+// The keys held by at least threshold of the views, each yielded once per rank as in
+// set_union_view, from the lowest-numbered input that holds it. A threshold of one gives the
+// union and a threshold of sizeof...(Views) the intersection; zero is treated as one.
+template<class Comp, class Proj, input_range... Views>
+  requires(view<Views> && ...) && (sizeof...(Views) > 0) && is_object_v<Comp> &&
+  is_object_v<Proj> && __detail::__pairwise_projected_set_order<Comp, Proj, Views...> &&
+  __detail::__concatable<Views...>
+class set_threshold_view : public view_interface<set_threshold_view<Comp, Proj, Views...>> {
+  [[no_unique_address]] __detail::__box<Comp> comp_;  // exposition only
+  [[no_unique_address]] __detail::__box<Proj> proj_;  // exposition only
+  [[no_unique_address]] tuple<Views...> views_;       // exposition only
+  size_t threshold_ = 1;                              // exposition only
+
+  class iterator {
+    friend set_threshold_view;
+
+    using merged_reference = __detail::__concat_reference_t<Views...>;  // exposition only
+    using merged_key =
+      common_reference_t<__detail::__key_reference_t<Proj, iterator_t<Views>>...>;
+
+    tuple<iterator_t<Views>...> current_;  // exposition only
+    tuple<sentinel_t<Views>...> end_;      // exposition only
+    [[no_unique_address]] tuple<
+      __detail::__key_cache<Proj, iterator_t<Views>>...> keys_;  // exposition only
+    set_threshold_view* parent_ = nullptr;
+    size_t active_idx_ = -1;          // exposition only
+    bitset<sizeof...(Views)> group_;  // exposition only
+    // A min-heap of the live cursors outside the current group, ordered by key and then index.
+    array<size_t, sizeof...(Views)> heap_;  // exposition only
+    size_t live_ = 0;                       // exposition only
+
+    template<size_t N>
+    constexpr void
+    refresh() {  // exposition only
+      std::get<N>(keys_).refresh(*parent_->proj_, std::get<N>(current_), std::get<N>(end_));
+    }
+
+    template<size_t N>
+    constexpr decltype(auto)
+    key() const {  // exposition only
+      return std::get<N>(keys_).get(std::get<N>(current_));
+    }
+
+    constexpr bool
+    at_end(size_t i) const {  // exposition only
+      return __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+        return std::get<N>(current_) == std::get<N>(end_);
+      });
+    }
+
+    constexpr merged_key
+    key_at(size_t i) const {  // exposition only
+      return __detail::__visit_index<sizeof...(Views)>(
+        i, [&]<size_t N> -> merged_key { return key<N>(); });
+    }
+
+    // Moves cursor i to the first key not less than target, galloping or seeking where it can.
+    template<class Key>
+    constexpr void
+    skip_to(size_t i, const Key& target) {  // exposition only
+      __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      });
+    }
+
+    // Whether cursor j comes before cursor i, so that the heap keeps the least key on top.
+    constexpr bool
+    after(size_t i, size_t j) const {  // exposition only
+      const weak_ordering c = __detail::__set_compare(*parent_->comp_, key_at(j), key_at(i));
+      return c < 0 || (c == 0 && j < i);
+    }
+
+    constexpr void
+    push(size_t i) {  // exposition only
+      if (at_end(i))
+        return;
+      heap_[live_++] = i;
+      ranges::push_heap(heap_.begin(), heap_.begin() + live_,
+                        [this](size_t x, size_t y) { return after(x, y); });
+    }
+
+    constexpr size_t
+    pop() {  // exposition only
+      ranges::pop_heap(heap_.begin(), heap_.begin() + live_,
+                       [this](size_t x, size_t y) { return after(x, y); });
+      return heap_[--live_];
+    }
+
+    constexpr void
+    rebuild() {  // exposition only
+      live_ = 0;
+      for (size_t i = 0; i != sizeof...(Views); ++i)
+        if (!at_end(i))
+          heap_[live_++] = i;
+      ranges::make_heap(heap_.begin(), heap_.begin() + live_,
+                        [this](size_t x, size_t y) { return after(x, y); });
+    }
+
+    // Pops the threshold least cursors off the heap. When the least of them already holds the key
+    // of the threshold-th, so do all of them and that key is a match; the cursors left on the heap
+    // that hold it join the group. Otherwise no key below the threshold-th can be held by enough
+    // inputs, so the cursors before it skip straight to it and go back on the heap.
+    constexpr void
+    satisfy() {  // exposition only
+      const size_t threshold = ranges::max(parent_->threshold_, 1uz);
+      array<size_t, sizeof...(Views)> least;
+      group_.reset();
+      while (true) {
+        if (live_ < threshold) {
+          active_idx_ = -1;
+          return;
+        }
+        for (size_t j = 0; j != threshold; ++j)
+          least[j] = pop();
+        const size_t candidate = least[threshold - 1];
+        const merged_key target = key_at(candidate);
+        if (__detail::__set_less(*parent_->comp_, key_at(least[0]), target)) {
+          for (size_t j = 0; j != threshold - 1; ++j) {
+            skip_to(least[j], target);
+            push(least[j]);
+          }
+          push(candidate);
+          continue;
+        }
+        for (size_t j = 0; j != threshold; ++j)
+          group_.set(least[j]);
+        while (live_ != 0 && !__detail::__set_less(*parent_->comp_, target, key_at(heap_[0])))
+          group_.set(pop());
+        active_idx_ = least[0];
+        return;
+      }
+    }
+
+    constexpr explicit iterator(set_threshold_view* parent, tuple<iterator_t<Views>...> current)
+      : parent_(parent),
+        current_(std::move(current)),
+        end_(__detail::__tuple_transform(ranges::end, parent->views_)) {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
+      rebuild();
+      satisfy();
+    }
+
+   public:
+    using iterator_concept =
+      conditional_t<(forward_range<Views> && ...), forward_iterator_tag, input_iterator_tag>;
+    using value_type = __detail::__concat_value_t<Views...>;
+    using difference_type = common_type_t<range_difference_t<Views>...>;
+
+    iterator()
+      requires(default_initializable<iterator_t<Views>> && ...)
+    = default;
+
+    // How many inputs hold the current key.
+    constexpr size_t
+    matches() const noexcept {
+      return group_.count();
+    }
+
+    constexpr merged_reference
+    operator*() const {
+      return __detail::__visit_index<sizeof...(Views)>(
+        active_idx_, [&]<size_t N> -> merged_reference { return *std::get<N>(current_); });
+    }
+
+    constexpr iterator&
+    operator++() {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        if (group_[N]) {
+          ++std::get<N>(current_);
+          refresh<N>();
+          push(N);
+        }
+      }
+      satisfy();
+      return *this;
+    }
+
+    constexpr void
+    operator++(int) {
+      ++*this;
+    }
+
+    constexpr iterator
+    operator++(int)
+      requires(forward_range<Views> && ...)
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    // Moves to the first element whose key is not less than target, skipping ahead in every input
+    // rather than stepping through the elements in between.
+    template<class Key>
+      requires(__detail::__set_order<Comp&, __detail::__key_reference_t<Proj, iterator_t<Views>>,
+                                     const Key&> &&
+               ...)
+    constexpr void
+    seek(const Key& target) {
+      if (active_idx_ == -1 || !__detail::__set_less(*parent_->comp_, key_at(active_idx_), target))
+        return;
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      }
+      rebuild();
+      satisfy();
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y)
+      requires(equality_comparable<iterator_t<Views>> && ...)
+    {
+      return x.current_ == y.current_ && x.active_idx_ == y.active_idx_;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, default_sentinel_t) {
+      return x.active_idx_ == -1;
+    }
+
+    friend constexpr __detail::__concat_rvalue_reference_t<Views...>
+    iter_move(const iterator& i) {
+      return __detail::__visit_index<sizeof...(Views)>(
+        i.active_idx_, [&]<size_t N> -> __detail::__concat_rvalue_reference_t<Views...> {
+          return ranges::iter_move(std::get<N>(i.current_));
+        });
+    }
+  };  // exposition only
+
+  static constexpr bool caches_begin = (forward_range<Views> && ...);
+  [[no_unique_address]] __detail::__maybe_present_t<
+    caches_begin, __detail::__non_propagating_cache<iterator>> begin_;  // exposition only
+
+ public:
+  set_threshold_view() = default;
+
+  constexpr explicit set_threshold_view(size_t threshold, Comp comp, Views... bases)
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...), threshold_(threshold) { }
+
+  constexpr explicit set_threshold_view(size_t threshold, Comp comp, Proj proj, Views... bases)
+    : comp_(std::move(comp)),
+      proj_(std::move(proj)),
+      views_(std::move(bases)...),
+      threshold_(threshold) {
+    // __glibcxx_assert((ranges::is_sorted(bases, *comp_, *proj_) && ...));
+  }
+
+  constexpr size_t
+  threshold() const noexcept {
+    return threshold_;
+  }
+
+  constexpr iterator
+  begin() {
+    if constexpr (caches_begin) {
+      if (!begin_._M_has_value())
+        begin_._M_emplace(iterator(this, __detail::__tuple_transform(ranges::begin, views_)));
+      return *begin_;
+    } else
+      return iterator(this, __detail::__tuple_transform(ranges::begin, views_));
+  }
+
+  constexpr default_sentinel_t
+  end() const noexcept {
+    return default_sentinel;
+  }
+
+  // Every element yielded uses up one element from each of at least threshold inputs.
+  constexpr auto
+  reserve_hint()
+    requires(approximately_sized_range<Views> && ...)
+  {
+    return std::apply(
+      [this](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return CT((CT(hints) + ...) / ranges::max(threshold_, 1uz));
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires(approximately_sized_range<const Views> && ...)
+  {
+    return std::apply(
+      [this](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return CT((CT(hints) + ...) / ranges::max(threshold_, 1uz));
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
+};
+
+template<class Comp, class... Rs>
+set_threshold_view(size_t, Comp, Rs&&...)
+  -> set_threshold_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!range<Proj>)
+set_threshold_view(size_t, Comp, Proj, Rs&&...)
+  -> set_threshold_view<Comp, Proj, views::all_t<Rs>...>;
+
+namespace views {
+namespace __detail {
+template<class Comp, class... Args>
+concept __can_set_threshold_view = requires {
+  set_threshold_view(std::declval<size_t>(), std::declval<Comp>(), std::declval<Args>()...);
+};
+}  // namespace __detail
+
+// set_threshold_by(threshold, comp, [proj,] rs...)
+struct SetThresholdBy {
+  template<class Comp, class... Args>
+    requires __detail::__can_set_threshold_view<Comp, Args...>
+  constexpr auto
+  operator() [[nodiscard]] (size_t threshold, Comp&& comp, Args&&... args) const {
+    return set_threshold_view(threshold, std::forward<Comp>(comp), std::forward<Args>(args)...);
+  }
+};
+
+inline constexpr SetThresholdBy set_threshold_by;
+
+// set_threshold(threshold, rs...)
+struct SetThreshold {
+  template<class... Rs>
+    requires __detail::__can_set_threshold_view<ranges::less, Rs...>
+  constexpr auto
+  operator() [[nodiscard]] (size_t threshold, Rs&&... rs) const {
+    return set_threshold_view(threshold, ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetThreshold set_threshold;
+}  // namespace views
+
+}  // namespace std::ranges
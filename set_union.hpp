@@ -1,12 +1,15 @@
 #include "concepts.hpp"
+#include "merge_tree.h"
+#include "roaring.hpp"
 
 namespace std::ranges {
-template<class Comp, input_range... Views>
+template<class Comp, class Proj, input_range... Views>
   requires(view<Views> && ...) && (sizeof...(Views) > 0) && is_object_v<Comp> &&
-  __detail::__pairwise_indirect_strict_weak_order<Comp, Views...> &&
+  is_object_v<Proj> && __detail::__pairwise_projected_set_order<Comp, Proj, Views...> &&
   __detail::__concatable<Views...>
-class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
+class set_union_view : public view_interface<set_union_view<Comp, Proj, Views...>> {
   [[no_unique_address]] __detail::__box<Comp> comp_;
+  [[no_unique_address]] __detail::__box<Proj> proj_;
   [[no_unique_address]] tuple<Views...> views_;
 
   // TODO: iterator_category
@@ -14,21 +17,99 @@ class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
   class iterator {
     friend set_union_view;
 
+    using merged_reference =
+      __detail::__concat_reference_t<__detail::__maybe_const_t<Const, Views>...>;
+    using merged_key = common_reference_t<
+      __detail::__key_reference_t<Proj, iterator_t<__detail::__maybe_const_t<Const, Views>>>...>;
+
+    // With many inputs, keep the cursors in a tournament tree so each step costs O(log K)
+    // comparisons. Tree comparisons go through the common reference of the keys, so only take
+    // that route when it is a true reference and reading a key does not materialize a copy.
+    static constexpr bool use_tree = sizeof...(Views) > __detail::__merge_tree_threshold &&
+      is_reference_v<merged_key> &&
+      __detail::__set_order<__detail::__maybe_const_t<Const, Comp>&, merged_key>;
+
     tuple<iterator_t<__detail::__maybe_const_t<Const, Views>>...> current_;
+    tuple<sentinel_t<__detail::__maybe_const_t<Const, Views>>...> end_;
+    [[no_unique_address]] tuple<
+      __detail::__key_cache<Proj, iterator_t<__detail::__maybe_const_t<Const, Views>>>...> keys_;
     __detail::__maybe_const_t<Const, set_union_view>* parent_ = nullptr;
     // or constexpr static no_active = sizeof...(Views);
     size_t active_idx_ = -1;
+    [[no_unique_address]] __detail::__maybe_present_t<
+      use_tree, __detail::__tournament_tree<sizeof...(Views)>> tree_;
 
     constexpr explicit iterator(
       __detail::__maybe_const_t<Const, set_union_view>* parent,
       tuple<iterator_t<__detail::__maybe_const_t<Const, Views>>...> current)
-      : parent_(parent), current_(std::move(current)) {
+      : parent_(parent),
+        current_(std::move(current)),
+        end_(__detail::__tuple_transform(ranges::end, parent->views_)) {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
+      if constexpr (use_tree)
+        tree_.build([this](size_t i, size_t j) { return ahead(i, j); });
       satisfy();
     }
 
     constexpr iterator(iterator<!Const> i)
-      requires Const && (convertible_to<iterator_t<Views>, iterator_t<const Views>> && ...)
-      : current_(i.current_), parent_(i.parent_), active_idx_(i.active_idx_) { }
+      requires Const && (convertible_to<iterator_t<Views>, iterator_t<const Views>> && ...) &&
+                 (convertible_to<sentinel_t<Views>, sentinel_t<const Views>> && ...)
+      : current_(i.current_), end_(i.end_), parent_(i.parent_), active_idx_(i.active_idx_) {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
+      if constexpr (use_tree && iterator<!Const>::use_tree)
+        tree_ = i.tree_;
+      else if constexpr (use_tree) {
+        tree_.build([this](size_t a, size_t b) { return ahead(a, b); });
+        satisfy();
+      }
+    }
+
+    template<size_t N>
+    constexpr void
+    refresh() {
+      std::get<N>(keys_).refresh(*parent_->proj_, std::get<N>(current_), std::get<N>(end_));
+    }
+
+    template<size_t N>
+    constexpr decltype(auto)
+    key() const {
+      return std::get<N>(keys_).get(std::get<N>(current_));
+    }
+
+    constexpr bool
+    at_end(size_t i) const {
+      return __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+        return std::get<N>(current_) == std::get<N>(end_);
+      });
+    }
+
+    constexpr merged_reference
+    deref(size_t i) const {
+      return __detail::__visit_index<sizeof...(Views)>(
+        i, [&]<size_t N> -> merged_reference { return *std::get<N>(current_); });
+    }
+
+    constexpr merged_key
+    key_at(size_t i) const {
+      return __detail::__visit_index<sizeof...(Views)>(
+        i, [&]<size_t N> -> merged_key { return key<N>(); });
+    }
+
+    // Whether cursor i is ahead of cursor j in the tree: live before exhausted, then by key, then
+    // by index so that equal keys are taken from the earliest input, as the linear scan does.
+    constexpr bool
+    ahead(size_t i, size_t j) const {
+      if (at_end(j))
+        return !at_end(i) || i < j;
+      if (at_end(i))
+        return false;
+      const weak_ordering order = __detail::__set_compare(*parent_->comp_, key_at(i), key_at(j));
+      return order < 0 || (order == 0 && i < j);
+    }
 
     template<class F>
     constexpr decltype(auto)
@@ -52,21 +133,35 @@ class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
 
     constexpr void
     satisfy() {
+      if constexpr (use_tree) {
+        active_idx_ = tree_.top();
+        if (at_end(active_idx_)) {
+          active_idx_ = -1;
+          return;
+        }
+        tree_.gather([this](size_t i, size_t j) { return ahead(i, j); },
+                     [this](size_t i) {
+                       return !at_end(i) &&
+                         !__detail::__set_less(*parent_->comp_, key_at(active_idx_), key_at(i));
+                     });
+        return;
+      }
       active_idx_ = -1;
       template for (constexpr size_t N : views::indices(sizeof...(Views))) {
-        if (std::get<N>(current_) == ranges::end(std::get<N>(parent_->views_)))
+        if (std::get<N>(current_) == std::get<N>(end_))
           continue;
         if (active_idx_ == -1)
           active_idx_ = N;
         else if (visit_active([&]<size_t ActiveIdx> {
-                   return std::__invoke(*parent_->comp_, *std::get<N>(current_),
-                                        *std::get<ActiveIdx>(current_));
+                   return __detail::__set_less(*parent_->comp_, key<N>(), key<ActiveIdx>());
                  }))
           active_idx_ = N;
       }
     }
 
    public:
+    // Forward only; the binary view in set_algo.hpp is bidirectional over bidirectional common
+    // inputs.
     using iterator_concept =
       conditional_t<(forward_range<__detail::__maybe_const_t<Const, Views>> && ...),
                     forward_iterator_tag, input_iterator_tag>;
@@ -78,24 +173,40 @@ class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
 
     constexpr __detail::__concat_reference_t<__detail::__maybe_const_t<Const, Views>...>
     operator*() const {
+      if constexpr (use_tree)
+        return deref(active_idx_);
       return visit_active(
         [&]<size_t ActiveIdx> -> decltype(auto) { return *std::get<ActiveIdx>(current_); });
     }
 
     constexpr iterator&
     operator++() {
+      if constexpr (use_tree) {
+        tree_.release([this](size_t i, size_t j) { return ahead(i, j); },
+                      [this](size_t i) {
+                        __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+                          ++std::get<N>(current_);
+                          refresh<N>();
+                        });
+                      });
+        satisfy();
+        return *this;
+      }
       visit_active([&]<size_t ActiveIdx> {
         template for (constexpr size_t N : views::indices(sizeof...(Views))) {
           if constexpr (N != ActiveIdx) {
             auto& other = std::get<N>(current_);
-            if (other == ranges::end(std::get<N>(parent_->views_)))
+            if (other == std::get<N>(end_))
               continue;
-            if (!std::__invoke(*parent_->comp_, *other, *std::get<ActiveIdx>(current_)) &&
-                !std::__invoke(*parent_->comp_, *std::get<ActiveIdx>(current_), *other))
+            // The active cursor holds the least key, so other is equivalent unless greater.
+            if (!__detail::__set_less(*parent_->comp_, key<ActiveIdx>(), key<N>())) {
               ++other;
+              refresh<N>();
+            }
           }
         }
         ++get<ActiveIdx>(current_);
+        refresh<ActiveIdx>();
       });
       satisfy();
       return *this;
@@ -115,6 +226,31 @@ class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
       return tmp;
     }
 
+    // Moves to the first element whose key is not less than target, skipping ahead in every input
+    // rather than stepping through the elements in between.
+    template<class Key>
+      requires(__detail::__set_order<
+                 __detail::__maybe_const_t<Const, Comp>&,
+                 __detail::__key_reference_t<
+                   Proj, iterator_t<__detail::__maybe_const_t<Const, Views>>>,
+                 const Key&> &&
+               ...)
+    constexpr void
+    seek(const Key& target) {
+      if (active_idx_ == -1 || !visit_active([&]<size_t ActiveIdx> {
+            return __detail::__set_less(*parent_->comp_, key<ActiveIdx>(), target);
+          }))
+        return;
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      }
+      if constexpr (use_tree)
+        tree_.reset([this](size_t i, size_t j) { return ahead(i, j); });
+      satisfy();
+    }
+
     friend constexpr bool
     operator==(const iterator& x, const iterator& y)
       requires(forward_range<__detail::__maybe_const_t<Const, Views>> && ...)
@@ -125,7 +261,7 @@ class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
     friend constexpr bool
     operator==(const iterator& it, default_sentinel_t) {
       template for (constexpr size_t N : views::indices(sizeof...(Views))) {
-        if (std::get<N>(it.current_) != ranges::end(std::get<N>(it.parent_->views_)))
+        if (std::get<N>(it.current_) != std::get<N>(it.end_))
           return false;
       }
       return it.active_idx_ == -1;
@@ -140,20 +276,33 @@ class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
     }
   };
 
+  static constexpr bool caches_begin = (forward_range<Views> && ...);
+  [[no_unique_address]] __detail::__maybe_present_t<
+    caches_begin, __detail::__non_propagating_cache<iterator<false>>> begin_;
+
  public:
   set_union_view() = default;
   constexpr explicit set_union_view(Comp comp, Views... bases)
-    : comp_(std::move(comp)), views_(std::move(bases)...) { }
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...) { }
+  constexpr explicit set_union_view(Comp comp, Proj proj, Views... bases)
+    : comp_(std::move(comp)), proj_(std::move(proj)), views_(std::move(bases)...) { }
 
   constexpr iterator<false>
   begin() {
-    return iterator<false>(this, __detail::__tuple_transform(ranges::begin, views_));
+    if constexpr (caches_begin) {
+      if (!begin_._M_has_value())
+        begin_._M_emplace(
+          iterator<false>(this, __detail::__tuple_transform(ranges::begin, views_)));
+      return *begin_;
+    } else
+      return iterator<false>(this, __detail::__tuple_transform(ranges::begin, views_));
   }
 
   constexpr iterator<true>
   begin() const
     requires(range<const Views> && ...) &&
-    __detail::__pairwise_indirect_strict_weak_order<const Comp, const Views...> &&
+    __detail::__pairwise_projected_set_order<const Comp, const Proj, const Views...> &&
     __detail::__concatable<const Views...>
   {
     return iterator<true>(this, __detail::__tuple_transform(ranges::begin, views_));
@@ -164,23 +313,38 @@ class set_union_view : public view_interface<set_union_view<Comp, Views...>> {
     return default_sentinel;
   }
 
-  // constexpr auto
-  // reserve_hint()
-  //   requires approximately_sized_range<Views...[0]>
-  // {
-  //   return ranges::reserve_hint(std::get<0>(views_));
-  // }
-
-  // constexpr auto
-  // reserve_hint() const
-  //   requires approximately_sized_range<const Views...[0]>
-  // {
-  //   return ranges::reserve_hint(std::get<0>(views_));
-  // }
+  // No more elements than all inputs together.
+  constexpr auto
+  reserve_hint()
+    requires(approximately_sized_range<Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return (CT(hints) + ...);
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires(approximately_sized_range<const Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return (CT(hints) + ...);
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
 };
 
 template<class Comp, class... Rs>
-set_union_view(Comp, Rs&&...) -> set_union_view<Comp, views::all_t<Rs>...>;
+set_union_view(Comp, Rs&&...) -> set_union_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!range<Proj>)
+set_union_view(Comp, Proj, Rs&&...) -> set_union_view<Comp, Proj, views::all_t<Rs>...>;
 
 namespace views {
 namespace __detail {
@@ -205,7 +369,10 @@ struct SetUnion {
     requires __detail::__can_set_union_view<ranges::less, Rs...>
   constexpr auto
   operator() [[nodiscard]] (Rs&&... rs) const {
-    return set_union_view(ranges::less{}, std::forward<Rs>(rs)...);
+    if constexpr ((ranges::__detail::__roaring_operand<Rs> && ...))
+      return roaring_combine_view(bit_or<>{}, std::forward<Rs>(rs)...);
+    else
+      return set_union_view(ranges::less{}, std::forward<Rs>(rs)...);
   }
 };
 
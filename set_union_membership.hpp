@@ -0,0 +1,362 @@
+#pragma once
+#include <bitset>
+#include <optional>
+#include <ranges>
+
+#include "concepts.h"
+#include "merge_tree.h"
+
+namespace std::ranges::__detail {
+// Whether the key read through a __key_cache lives in the element rather than in the cache,
+// so that it may be handed out past the lifetime of the cursor it was read from.
+template<class Proj, class I>
+concept __key_outlives_cursor = same_as<Proj, identity> ||
+  (is_lvalue_reference_v<indirect_result_t<Proj&, I>> &&
+   is_lvalue_reference_v<iter_reference_t<I>>);
+}  // namespace std::ranges::__detail
+
+namespace std::ranges {
+// One step of a set_union_membership_view: a key, which inputs hold it, and the element each of
+// those inputs contributed. A step that refers into the inputs converts to one that owns copies,
+// which is what the view's value_type holds.
+template<class Key, size_t K, class... Elements>
+struct set_membership {
+  Key key;
+  bitset<K> inputs;
+  tuple<optional<Elements>...> elements;
+
+  template<class OtherKey, class... OtherElements>
+    requires(!same_as<set_membership<OtherKey, K, OtherElements...>, set_membership>) &&
+            (!is_reference_v<OtherKey>) && (!is_reference_v<OtherElements> && ...) &&
+            constructible_from<OtherKey, const Key&> &&
+            (constructible_from<OtherElements, const Elements&> && ...)
+  constexpr
+  operator set_membership<OtherKey, K, OtherElements...>() const {
+    return {OtherKey(key), inputs, tuple<optional<OtherElements>...>(elements)};
+  }
+};
+
+// The union of the views, where each element also reports which inputs it was found in. Equal
+// elements are grouped rank by rank across the inputs as in set_union_view, and every input
+// holding the group's key gives up one element per step.
+template<class Comp, class Proj, input_range... Views>
+  requires(view<Views> && ...) && (sizeof...(Views) > 0) && is_object_v<Comp> &&
+  is_object_v<Proj> && __detail::__pairwise_projected_set_order<Comp, Proj, Views...>
+class set_union_membership_view
+  : public view_interface<set_union_membership_view<Comp, Proj, Views...>> {
+  [[no_unique_address]] __detail::__box<Comp> comp_;  // exposition only
+  [[no_unique_address]] __detail::__box<Proj> proj_;  // exposition only
+  [[no_unique_address]] tuple<Views...> views_;       // exposition only
+
+  class iterator {
+    friend set_union_membership_view;
+
+    using merged_key =
+      common_reference_t<__detail::__key_reference_t<Proj, iterator_t<Views>>...>;
+    // The key is yielded by reference only when it does not point into this iterator.
+    using key_type =
+      conditional_t<(__detail::__key_outlives_cursor<Proj, iterator_t<Views>> && ...),
+                    merged_key, remove_cvref_t<merged_key>>;
+
+    static constexpr bool use_tree = sizeof...(Views) > __detail::__merge_tree_threshold &&
+      is_reference_v<merged_key> && __detail::__set_order<Comp&, merged_key>;
+
+    tuple<iterator_t<Views>...> current_;  // exposition only
+    tuple<sentinel_t<Views>...> end_;      // exposition only
+    [[no_unique_address]] tuple<
+      __detail::__key_cache<Proj, iterator_t<Views>>...> keys_;  // exposition only
+    set_union_membership_view* parent_ = nullptr;
+    // The lowest-numbered input of the current group and the set of all inputs in it.
+    size_t active_idx_ = -1;           // exposition only
+    bitset<sizeof...(Views)> inputs_;  // exposition only
+    [[no_unique_address]] __detail::__maybe_present_t<
+      use_tree, __detail::__tournament_tree<sizeof...(Views)>> tree_;  // exposition only
+
+    template<size_t N>
+    constexpr void
+    refresh() {  // exposition only
+      std::get<N>(keys_).refresh(*parent_->proj_, std::get<N>(current_), std::get<N>(end_));
+    }
+
+    template<size_t N>
+    constexpr decltype(auto)
+    key() const {  // exposition only
+      return std::get<N>(keys_).get(std::get<N>(current_));
+    }
+
+    constexpr bool
+    at_end(size_t i) const {  // exposition only
+      return __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+        return std::get<N>(current_) == std::get<N>(end_);
+      });
+    }
+
+    constexpr merged_key
+    key_at(size_t i) const {  // exposition only
+      return __detail::__visit_index<sizeof...(Views)>(
+        i, [&]<size_t N> -> merged_key { return key<N>(); });
+    }
+
+    constexpr bool
+    ahead(size_t i, size_t j) const {  // exposition only
+      if (at_end(j))
+        return !at_end(i) || i < j;
+      if (at_end(i))
+        return false;
+      const weak_ordering order = __detail::__set_compare(*parent_->comp_, key_at(i), key_at(j));
+      return order < 0 || (order == 0 && i < j);
+    }
+
+    template<class F>
+    constexpr decltype(auto)
+    visit_active(F&& f) const {  // exposition only
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        if (N == active_idx_)
+          return std::forward<F>(f).template operator()<N>();
+      }
+      unreachable();
+    }
+
+    // Finds the least key and every input that holds it.
+    constexpr void
+    satisfy() {  // exposition only
+      inputs_.reset();
+      if constexpr (use_tree) {
+        active_idx_ = tree_.top();
+        if (at_end(active_idx_)) {
+          active_idx_ = -1;
+          return;
+        }
+        tree_.gather([this](size_t i, size_t j) { return ahead(i, j); },
+                     [this](size_t i) {
+                       return !at_end(i) &&
+                         !__detail::__set_less(*parent_->comp_, key_at(active_idx_), key_at(i));
+                     });
+        for (size_t i : tree_.group())
+          inputs_.set(i);
+        return;
+      }
+      active_idx_ = -1;
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        if (std::get<N>(current_) == std::get<N>(end_))
+          continue;
+        if (active_idx_ == -1) {
+          active_idx_ = N;
+          inputs_.set(N);
+          continue;
+        }
+        const weak_ordering order = visit_active([&]<size_t ActiveIdx> {
+          return __detail::__set_compare(*parent_->comp_, key<N>(), key<ActiveIdx>());
+        });
+        if (order < 0) {
+          active_idx_ = N;
+          inputs_.reset();
+          inputs_.set(N);
+        } else if (order == 0)
+          inputs_.set(N);
+      }
+    }
+
+    constexpr explicit iterator(set_union_membership_view* parent,
+                                tuple<iterator_t<Views>...> current)
+      : parent_(parent),
+        current_(std::move(current)),
+        end_(__detail::__tuple_transform(ranges::end, parent->views_)) {
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        refresh<N>();
+      }
+      if constexpr (use_tree)
+        tree_.build([this](size_t i, size_t j) { return ahead(i, j); });
+      satisfy();
+    }
+
+   public:
+    using reference = set_membership<key_type, sizeof...(Views),
+                                     __detail::__optional_element_t<range_reference_t<Views>>...>;
+    using iterator_concept =
+      conditional_t<(forward_range<Views> && ...), forward_iterator_tag, input_iterator_tag>;
+    using value_type =
+      set_membership<remove_cvref_t<merged_key>, sizeof...(Views), range_value_t<Views>...>;
+    using difference_type = common_type_t<range_difference_t<Views>...>;
+
+    iterator()
+      requires(default_initializable<iterator_t<Views>> && ...)
+    = default;
+
+    constexpr reference
+    operator*() const {
+      reference result{
+        visit_active([&]<size_t ActiveIdx> -> key_type { return key<ActiveIdx>(); }), inputs_};
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        if (inputs_[N])
+          std::get<N>(result.elements).emplace(*std::get<N>(current_));
+      }
+      return result;
+    }
+
+    constexpr iterator&
+    operator++() {
+      if constexpr (use_tree)
+        tree_.release([this](size_t i, size_t j) { return ahead(i, j); },
+                      [this](size_t i) {
+                        __detail::__visit_index<sizeof...(Views)>(i, [&]<size_t N> {
+                          ++std::get<N>(current_);
+                          refresh<N>();
+                        });
+                      });
+      else {
+        template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+          if (inputs_[N]) {
+            ++std::get<N>(current_);
+            refresh<N>();
+          }
+        }
+      }
+      satisfy();
+      return *this;
+    }
+
+    constexpr void
+    operator++(int) {
+      ++*this;
+    }
+
+    constexpr iterator
+    operator++(int)
+      requires(forward_range<Views> && ...)
+    {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    // Moves to the first element whose key is not less than target, skipping ahead in every input
+    // rather than stepping through the elements in between.
+    template<class Key>
+      requires(__detail::__set_order<Comp&, __detail::__key_reference_t<Proj, iterator_t<Views>>,
+                                     const Key&> &&
+               ...)
+    constexpr void
+    seek(const Key& target) {
+      if (active_idx_ == -1 || !__detail::__set_less(*parent_->comp_, key_at(active_idx_), target))
+        return;
+      template for (constexpr size_t N : views::indices(sizeof...(Views))) {
+        __detail::__seek_to(*parent_->comp_, *parent_->proj_, std::get<N>(current_),
+                            std::get<N>(end_), target);
+        refresh<N>();
+      }
+      if constexpr (use_tree)
+        tree_.reset([this](size_t i, size_t j) { return ahead(i, j); });
+      satisfy();
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, const iterator& y)
+      requires(equality_comparable<iterator_t<Views>> && ...)
+    {
+      return x.current_ == y.current_ && x.active_idx_ == y.active_idx_;
+    }
+
+    friend constexpr bool
+    operator==(const iterator& x, default_sentinel_t) {
+      return x.active_idx_ == -1;
+    }
+  };  // exposition only
+
+  static constexpr bool caches_begin = (forward_range<Views> && ...);
+  [[no_unique_address]] __detail::__maybe_present_t<
+    caches_begin, __detail::__non_propagating_cache<iterator>> begin_;  // exposition only
+
+ public:
+  set_union_membership_view() = default;
+
+  constexpr explicit set_union_membership_view(Comp comp, Views... bases)
+    requires default_initializable<Proj>
+    : comp_(std::move(comp)), proj_(Proj()), views_(std::move(bases)...) { }
+
+  constexpr explicit set_union_membership_view(Comp comp, Proj proj, Views... bases)
+    : comp_(std::move(comp)), proj_(std::move(proj)), views_(std::move(bases)...) {
+    // __glibcxx_assert((ranges::is_sorted(bases, *comp_, *proj_) && ...));
+  }
+
+  constexpr iterator
+  begin() {
+    if constexpr (caches_begin) {
+      if (!begin_._M_has_value())
+        begin_._M_emplace(iterator(this, __detail::__tuple_transform(ranges::begin, views_)));
+      return *begin_;
+    } else
+      return iterator(this, __detail::__tuple_transform(ranges::begin, views_));
+  }
+
+  constexpr default_sentinel_t
+  end() const noexcept {
+    return default_sentinel;
+  }
+
+  // No more elements than all inputs together.
+  constexpr auto
+  reserve_hint()
+    requires(approximately_sized_range<Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return (CT(hints) + ...);
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
+
+  constexpr auto
+  reserve_hint() const
+    requires(approximately_sized_range<const Views> && ...)
+  {
+    return std::apply(
+      [](auto... hints) {
+        using CT = __detail::__make_unsigned_like_t<common_type_t<decltype(hints)...>>;
+        return (CT(hints) + ...);
+      },
+      __detail::__tuple_transform(ranges::reserve_hint, views_));
+  }
+};
+
+template<class Comp, class... Rs>
+set_union_membership_view(Comp, Rs&&...)
+  -> set_union_membership_view<Comp, identity, views::all_t<Rs>...>;
+
+template<class Comp, class Proj, class... Rs>
+  requires(!range<Proj>)
+set_union_membership_view(Comp, Proj, Rs&&...)
+  -> set_union_membership_view<Comp, Proj, views::all_t<Rs>...>;
+
+namespace views {
+namespace __detail {
+template<class Comp, class... Args>
+concept __can_set_union_membership_view =
+  requires { set_union_membership_view(std::declval<Comp>(), std::declval<Args>()...); };
+}  // namespace __detail
+
+struct SetUnionMembershipBy {
+  template<class Comp, class... Args>
+    requires __detail::__can_set_union_membership_view<Comp, Args...>
+  constexpr auto
+  operator() [[nodiscard]] (Comp&& comp, Args&&... args) const {
+    return set_union_membership_view(std::forward<Comp>(comp), std::forward<Args>(args)...);
+  }
+};
+
+inline constexpr SetUnionMembershipBy set_union_membership_by;
+
+struct SetUnionMembership {
+  template<class... Rs>
+    requires __detail::__can_set_union_membership_view<ranges::less, Rs...>
+  constexpr auto
+  operator() [[nodiscard]] (Rs&&... rs) const {
+    return set_union_membership_view(ranges::less{}, std::forward<Rs>(rs)...);
+  }
+};
+
+inline constexpr SetUnionMembership set_union_membership;
+}  // namespace views
+
+}  // namespace std::ranges